@@ -0,0 +1,253 @@
+#include <NovusTypes.h>
+#include <Utils/ByteBuffer.h>
+#include <Utils/srp.h>
+#include <entt.hpp>
+#include "../Network/AuthWorkerPool.h"
+#include "../Network/AccountCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// A login wave of SRP-6a handshakes, every challenge and handshake arrives on the same tick
+// The server side math runs once on the tick itself, the way it did before AuthWorkerPool, and once on the auth workers while the tick keeps going
+// Usage: novus-world-auth-benchmark [numLogins] [numWorkers...]
+
+#define AUTH_BENCHMARK_NUM_LOGINS 1000
+#define AUTH_BENCHMARK_TICK_MS 33
+#define AUTH_BENCHMARK_TIMEOUT_S 120.0
+
+// Everything the verifications produce ends up here, so the compiler can't drop the work
+static volatile u64 benchmarkChecksum = 0;
+
+// The client's half of a login, done up front so only the server side is timed
+// Accounts get a random salt and verifier, the sessions won't verify but the server does the same math either way
+struct BenchmarkLogin
+{
+    std::string username;
+    SRPUser user;
+    std::shared_ptr<SRPVerifier> verifier;
+};
+
+static std::vector<BenchmarkLogin> BuildLogins(u32 numLogins)
+{
+    std::mt19937 random(1337);
+    std::uniform_int_distribution<u32> byteDistribution(0, 255);
+
+    std::vector<BenchmarkLogin> logins(numLogins);
+    for (u32 i = 0; i < numLogins; i++)
+    {
+        BenchmarkLogin& login = logins[i];
+        login.username = "benchmark" + std::to_string(i);
+        login.user.username = login.username;
+        login.user.password = "password";
+        login.user.StartAuthentication();
+
+        std::shared_ptr<Bytebuffer> sBuffer = Bytebuffer::Borrow<ACCOUNT_CACHE_SALT_SIZE>();
+        std::shared_ptr<Bytebuffer> vBuffer = Bytebuffer::Borrow<ACCOUNT_CACHE_VERIFIER_SIZE>();
+        for (u32 j = 0; j < ACCOUNT_CACHE_SALT_SIZE; j++)
+        {
+            sBuffer->GetDataPointer()[j] = static_cast<u8>(byteDistribution(random));
+        }
+        for (u32 j = 0; j < ACCOUNT_CACHE_VERIFIER_SIZE; j++)
+        {
+            vBuffer->GetDataPointer()[j] = static_cast<u8>(byteDistribution(random));
+        }
+
+        login.verifier = std::make_shared<SRPVerifier>();
+        login.verifier->saltBuffer = sBuffer;
+        login.verifier->verifierBuffer = vBuffer;
+    }
+
+    return logins;
+}
+
+// The client answers the server's challenge, not timed
+static void AnswerChallenges(std::vector<BenchmarkLogin>& logins)
+{
+    for (BenchmarkLogin& login : logins)
+    {
+        login.user.ProcessChallenge(login.verifier->saltBuffer->GetDataPointer(), login.verifier->bBuffer->GetDataPointer());
+    }
+}
+
+static f64 GetElapsedSeconds(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<f64>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static void PrintResult(const char* name, u32 numLogins, f64 seconds, f64 longestTickSeconds, u32 numStarted, u32 numVerified)
+{
+    printf("%-10s %6u logins %8.2f s %10.1f logins/s  longest tick %9.2f ms  %u challenges answered, %u sessions verified\n", name, numLogins, seconds, numLogins / seconds, longestTickSeconds * 1000.0, numStarted, numVerified);
+}
+
+// Before AuthWorkerPool, every challenge and handshake of the wave is verified on the tick that received it
+static void BenchmarkTick(u32 numLogins)
+{
+    std::vector<BenchmarkLogin> logins = BuildLogins(numLogins);
+
+    u32 numStarted = 0;
+    u32 numVerified = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (BenchmarkLogin& login : logins)
+    {
+        numStarted += login.verifier->StartVerification(login.username, login.user.aBuffer->GetDataPointer());
+    }
+    f64 challengeSeconds = GetElapsedSeconds(start);
+
+    AnswerChallenges(logins);
+
+    start = std::chrono::high_resolution_clock::now();
+    for (BenchmarkLogin& login : logins)
+    {
+        numVerified += login.verifier->VerifySession(login.user.M);
+    }
+    f64 sessionSeconds = GetElapsedSeconds(start);
+
+    PrintResult("tick", numLogins, challengeSeconds + sessionSeconds, std::max(challengeSeconds, sessionSeconds), numStarted, numVerified);
+    benchmarkChecksum += numStarted + numVerified;
+}
+
+// Queues every job of the wave and keeps ticking until all completions were applied, returns false on timeout
+static bool RunOnWorkers(AuthWorkerPool& workers, std::vector<AuthJob>& jobs, f64& seconds, f64& longestTickSeconds)
+{
+    entt::registry registry;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (AuthJob& job : jobs)
+    {
+        workers.Enqueue(std::move(job));
+    }
+
+    size_t numApplied = 0;
+    longestTickSeconds = GetElapsedSeconds(start);
+
+    while (numApplied < jobs.size())
+    {
+        if (GetElapsedSeconds(start) > AUTH_BENCHMARK_TIMEOUT_S)
+        {
+            printf("Only %llu of %llu auth jobs finished\n", static_cast<unsigned long long>(numApplied), static_cast<unsigned long long>(jobs.size()));
+            return false;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(AUTH_BENCHMARK_TICK_MS));
+
+        // What AuthCompletionSystem does every tick
+        auto tickStart = std::chrono::high_resolution_clock::now();
+
+        AuthCompletion completion;
+        while (workers.TryGetCompletion(completion))
+        {
+            completion(registry);
+            numApplied++;
+        }
+
+        longestTickSeconds = std::max(longestTickSeconds, GetElapsedSeconds(tickStart));
+    }
+
+    seconds = GetElapsedSeconds(start);
+    return true;
+}
+
+static bool BenchmarkWorkers(u32 numLogins, u32 numWorkers)
+{
+    std::vector<BenchmarkLogin> logins = BuildLogins(numLogins);
+
+    AuthWorkerPool workers;
+    workers.Start(numWorkers);
+
+    u32 numStarted = 0;
+    u32 numVerified = 0;
+
+    std::vector<AuthJob> jobs;
+    jobs.reserve(numLogins);
+    for (BenchmarkLogin& login : logins)
+    {
+        jobs.push_back([srp = login.verifier, username = login.username, A = login.user.aBuffer, &numStarted]() -> AuthCompletion
+        {
+            bool didStart = srp->StartVerification(username, A->GetDataPointer());
+            return [didStart, &numStarted](entt::registry& /*registry*/)
+            {
+                numStarted += didStart;
+            };
+        });
+    }
+
+    f64 challengeSeconds = 0.0;
+    f64 longestChallengeTickSeconds = 0.0;
+    if (!RunOnWorkers(workers, jobs, challengeSeconds, longestChallengeTickSeconds))
+        return false;
+
+    AnswerChallenges(logins);
+
+    jobs.clear();
+    for (BenchmarkLogin& login : logins)
+    {
+        jobs.push_back([srp = login.verifier, M1 = login.user.M, &numVerified]() -> AuthCompletion
+        {
+            bool isVerified = srp->VerifySession(M1);
+            return [isVerified, &numVerified](entt::registry& /*registry*/)
+            {
+                numVerified += isVerified;
+            };
+        });
+    }
+
+    f64 sessionSeconds = 0.0;
+    f64 longestSessionTickSeconds = 0.0;
+    if (!RunOnWorkers(workers, jobs, sessionSeconds, longestSessionTickSeconds))
+        return false;
+
+    workers.Stop();
+
+    char name[16];
+    snprintf(name, sizeof(name), "%u workers", numWorkers);
+
+    PrintResult(name, numLogins, challengeSeconds + sessionSeconds, std::max(longestChallengeTickSeconds, longestSessionTickSeconds), numStarted, numVerified);
+    benchmarkChecksum += numStarted + numVerified;
+    return true;
+}
+
+i32 main(i32 argc, char* argv[])
+{
+    u32 numLogins = argc > 1 ? static_cast<u32>(std::strtoul(argv[1], nullptr, 10)) : AUTH_BENCHMARK_NUM_LOGINS;
+    if (numLogins == 0)
+    {
+        printf("Usage: %s [numLogins] [numWorkers...]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<u32> workerCounts;
+    for (i32 i = 2; i < argc; i++)
+    {
+        workerCounts.push_back(static_cast<u32>(std::strtoul(argv[i], nullptr, 10)));
+    }
+
+    if (workerCounts.empty())
+    {
+        workerCounts = { AUTH_WORKER_COUNT };
+    }
+
+    printf("A wave of %u logins, the tick runs every %u ms\n", numLogins, AUTH_BENCHMARK_TICK_MS);
+
+    BenchmarkTick(numLogins);
+
+    for (u32 numWorkers : workerCounts)
+    {
+        if (numWorkers == 0)
+            continue;
+
+        if (!BenchmarkWorkers(numLogins, numWorkers))
+            return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include <NovusTypes.h>
+#include <Database/DBConnection.h>
+#include <entt.hpp>
+#include "../Database/CreatureLoader.h"
+#include "../Database/DBWorkerPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+// Loads a creatures table the way the world server did before paging (one SELECT, decoded and inserted on the engine thread) and the way it does now (CreatureLoader)
+// Needs a scratch database of its own, the table is created and filled there and dropped again at the end
+// Usage: novus-world-creature-load-benchmark <host> <port> <user> <password> <scratch database> [numCreatures]
+
+#define CREATURE_LOAD_BENCHMARK_NUM_CREATURES 250000
+#define CREATURE_LOAD_BENCHMARK_INSERT_BATCH 1000
+
+// Ids are spread out like a table that had rows deleted, the pages are read by id so the gaps mustn't matter
+#define CREATURE_LOAD_BENCHMARK_ID_STRIDE 7
+
+// Everything that gets loaded ends up here, so the compiler can't drop the work
+static volatile u64 benchmarkChecksum = 0;
+
+static f64 GetElapsedSeconds(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<f64>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static void PrintResult(const char* name, size_t numCreatures, f64 seconds)
+{
+    printf("%-8s %8u creatures %10.2f ms %10.1f k creatures/s\n", name, static_cast<u32>(numCreatures), seconds * 1000.0, (numCreatures / seconds) / 1000.0);
+}
+
+static bool FillTable(DBConnection& connection, u32 numCreatures)
+{
+    std::mt19937 random(1337);
+    std::uniform_real_distribution<f32> positionDistribution(-8000.0f, 8000.0f);
+    std::uniform_real_distribution<f32> orientationDistribution(0.0f, 6.28f);
+    std::uniform_int_distribution<u32> displayDistribution(1, 30000);
+
+    std::string sql;
+    char row[160];
+
+    for (u32 first = 0; first < numCreatures; first += CREATURE_LOAD_BENCHMARK_INSERT_BATCH)
+    {
+        sql = "INSERT INTO `creatures` (`id`, `displayId`, `scale`, `positionX`, `positionY`, `positionZ`, `orientation`) VALUES ";
+
+        u32 last = std::min(first + CREATURE_LOAD_BENCHMARK_INSERT_BATCH, numCreatures);
+        for (u32 i = first; i < last; i++)
+        {
+            u64 id = static_cast<u64>(i) * CREATURE_LOAD_BENCHMARK_ID_STRIDE + 1;
+            snprintf(row, sizeof(row), "%s(%llu, %u, 1, %.3f, %.3f, %.3f, %.3f)", i == first ? "" : ", ", static_cast<unsigned long long>(id), displayDistribution(random),
+                positionDistribution(random), positionDistribution(random), positionDistribution(random) / 16.0f, orientationDistribution(random));
+            sql += row;
+        }
+
+        sql += ";";
+        if (!connection.Execute(sql))
+        {
+            printf("Failed to fill `creatures`, stopped at row %u\n", first);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// What the world server did before the load was paged, one query for the whole table with every row decoded on the engine thread
+static bool LoadInOneQuery(DBConnection& connection, entt::registry& registry, std::vector<SnapshotCreature>& creatures)
+{
+    std::shared_ptr<QueryResult> result = connection.Query("SELECT `id`, `displayId`, `scale`, `positionX`, `positionY`, `positionZ`, `orientation` FROM `creatures`;");
+    if (!result)
+        return false;
+
+    creatures.reserve(static_cast<size_t>(result->GetAffectedRows()));
+    while (result->GetNextRow())
+    {
+        SnapshotCreature& creature = creatures.emplace_back();
+        creature.displayID = result->GetField(1).GetU32();
+        creature.scale = result->GetField(2).GetF32();
+        creature.position = vec3(result->GetField(3).GetF32(), result->GetField(4).GetF32(), result->GetField(5).GetF32());
+        creature.orientation = result->GetField(6).GetF32();
+    }
+
+    CreatureLoader::Insert(registry, creatures.data(), creatures.size());
+    return true;
+}
+
+static bool Run(DBConnection& connection, const std::string& host, u16 port, const std::string& user, const std::string& password, const std::string& database, u32 numCreatures)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    if (!FillTable(connection, numCreatures))
+        return false;
+
+    printf("Filled `creatures` with %u rows (%.2f s), pages of %u\n", numCreatures, GetElapsedSeconds(start), CREATURE_LOAD_CHUNK_SIZE);
+
+    {
+        entt::registry registry;
+        std::vector<SnapshotCreature> creatures;
+
+        start = std::chrono::high_resolution_clock::now();
+        if (!LoadInOneQuery(connection, registry, creatures))
+        {
+            printf("Failed to load `creatures` in one query\n");
+            return false;
+        }
+
+        PrintResult("single", creatures.size(), GetElapsedSeconds(start));
+        benchmarkChecksum += creatures.size();
+    }
+
+    {
+        DBWorkerPool workers;
+        workers.Start(DB_WORKER_COUNT, [&](DBConnection& workerConnection)
+        {
+            workerConnection.Connect(host, port, user, password, database, 0);
+        });
+
+        entt::registry registry;
+        std::vector<SnapshotCreature> creatures;
+
+        start = std::chrono::high_resolution_clock::now();
+        bool didLoad = CreatureLoader::Load(connection, workers, registry, creatures);
+        f64 seconds = GetElapsedSeconds(start);
+
+        workers.Stop();
+
+        if (!didLoad || creatures.size() != numCreatures)
+        {
+            printf("Failed to load `creatures` in pages, got %u of %u\n", static_cast<u32>(creatures.size()), numCreatures);
+            return false;
+        }
+
+        PrintResult("paged", creatures.size(), seconds);
+        benchmarkChecksum += creatures.size();
+    }
+
+    return true;
+}
+
+i32 main(i32 argc, char* argv[])
+{
+    if (argc < 6)
+    {
+        printf("Usage: %s <host> <port> <user> <password> <scratch database> [numCreatures]\n", argv[0]);
+        return 1;
+    }
+
+    std::string host = argv[1];
+    u16 port = static_cast<u16>(std::strtoul(argv[2], nullptr, 10));
+    std::string user = argv[3];
+    std::string password = argv[4];
+    std::string database = argv[5];
+    u32 numCreatures = argc > 6 ? static_cast<u32>(std::strtoul(argv[6], nullptr, 10)) : CREATURE_LOAD_BENCHMARK_NUM_CREATURES;
+
+    DBConnection connection;
+    connection.Connect(host, port, user, password, database, 0);
+    if (!connection.Query("SELECT 1;"))
+    {
+        printf("Failed to connect to %s on %s:%u\n", database.c_str(), host.c_str(), port);
+        return 1;
+    }
+
+    // Never touches a table it didn't create, an existing `creatures` makes this fail right away
+    if (!connection.Execute("CREATE TABLE `creatures` (`id` BIGINT UNSIGNED NOT NULL, `displayId` INT UNSIGNED NOT NULL, `scale` FLOAT NOT NULL, `positionX` FLOAT NOT NULL, `positionY` FLOAT NOT NULL, `positionZ` FLOAT NOT NULL, `orientation` FLOAT NOT NULL, PRIMARY KEY (`id`));"))
+    {
+        printf("Failed to create `creatures` in %s, it has to be a scratch database without one\n", database.c_str());
+        return 1;
+    }
+
+    bool isSuccessful = Run(connection, host, port, user, password, database, numCreatures);
+    if (!connection.Execute("DROP TABLE `creatures`;"))
+    {
+        printf("Failed to drop `creatures` from %s\n", database.c_str());
+    }
+
+    return isSuccessful ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include <NovusTypes.h>
+#include <Networking/NetPacket.h>
+#include "../Network/PacketStreamDecoder.h"
+#include "../Network/ReceiveRing.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// Feeds a synthetic client stream through PacketStreamDecoder, once from a flat buffer (decoding alone) and once through a ReceiveRing (what the I/O threads do)
+// Usage: novus-world-decoder-benchmark [numPackets] [numIterations]
+
+#define DECODER_BENCHMARK_NUM_PACKETS 1000000
+#define DECODER_BENCHMARK_NUM_ITERATIONS 10
+
+// What a single recv() typically hands us, the stream is fed to the ring in chunks this big
+#define DECODER_BENCHMARK_CHUNK_SIZE 1460
+
+// Everything the sinks look at ends up here, so the compiler can't drop the work
+static volatile u64 benchmarkChecksum = 0;
+
+// A contiguous stream that is consumed as it is decoded, the cheapest source PacketStreamDecoder can have
+struct FlatSource
+{
+    const u8* data;
+    size_t size;
+    size_t readOffset = 0;
+
+    size_t GetActiveSize() const { return size - readOffset; }
+    void Peek(void* destination, size_t peekSize) const { std::memcpy(destination, data + readOffset, peekSize); }
+};
+
+// Mostly movement, the odd .storeloc / .goto with a short name, the mix a connected client sends
+static std::vector<u8> BuildStream(u32 numPackets)
+{
+    std::vector<u8> stream;
+    stream.reserve(static_cast<size_t>(numPackets) * (sizeof(PacketHeader) + 36));
+
+    std::mt19937 random(1337);
+    std::uniform_int_distribution<u32> kindDistribution(0, 99);
+    std::uniform_int_distribution<u32> nameDistribution(1, 32);
+
+    for (u32 i = 0; i < numPackets; i++)
+    {
+        u32 kind = kindDistribution(random);
+
+        PacketHeader header;
+        if (kind < 90)
+        {
+            header.opcode = Opcode::MSG_MOVE_ENTITY;
+            header.size = sizeof(f32) * 9;
+        }
+        else
+        {
+            header.opcode = kind < 95 ? Opcode::CMSG_STORELOC : Opcode::CMSG_GOTO;
+            header.size = static_cast<u16>(nameDistribution(random) + 1);
+        }
+
+        const u8* headerBytes = reinterpret_cast<const u8*>(&header);
+        stream.insert(stream.end(), headerBytes, headerBytes + sizeof(PacketHeader));
+
+        for (u16 j = 0; j < header.size; j++)
+        {
+            stream.push_back(static_cast<u8>(i + j));
+        }
+    }
+
+    return stream;
+}
+
+static f64 GetElapsedSeconds(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<f64>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static void PrintResult(const char* name, u64 numPackets, u64 numBytes, f64 seconds)
+{
+    printf("%-8s %10.2f M packets/s %10.2f MB/s %8.2f ns/packet\n", name, (numPackets / seconds) / 1000000.0, (numBytes / seconds) / (1024.0 * 1024.0), (seconds * 1000000000.0) / numPackets);
+}
+
+// Decoding alone, the sink only skips the payload
+static bool BenchmarkFlat(const std::vector<u8>& stream, u32 numExpectedPackets, u32 numIterations)
+{
+    u64 checksum = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (u32 iteration = 0; iteration < numIterations; iteration++)
+    {
+        FlatSource source = { stream.data(), stream.size() };
+
+        u32 numPackets = 0;
+        PacketStreamResult result = PacketStreamDecoder<RECEIVE_RING_MAX_PAYLOAD_SIZE>::Decode(source, [&source, &checksum](const PacketHeader& header)
+        {
+            checksum += static_cast<u16>(header.opcode) + header.size;
+            source.readOffset += sizeof(PacketHeader) + header.size;
+            return true;
+        }, numPackets);
+
+        if (result != PacketStreamResult::NEED_MORE_DATA || numPackets != numExpectedPackets)
+        {
+            printf("Flat decode failed (result %u, %u of %u packets)\n", static_cast<u32>(result), numPackets, numExpectedPackets);
+            return false;
+        }
+    }
+
+    f64 seconds = GetElapsedSeconds(start);
+    PrintResult("flat", static_cast<u64>(numExpectedPackets) * numIterations, static_cast<u64>(stream.size()) * numIterations, seconds);
+
+    benchmarkChecksum += checksum;
+    return true;
+}
+
+// The I/O thread path, the stream arrives in chunks and every packet is framed in place and released right away
+static bool BenchmarkRing(const std::vector<u8>& stream, u32 numExpectedPackets, u32 numIterations)
+{
+    u64 checksum = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (u32 iteration = 0; iteration < numIterations; iteration++)
+    {
+        std::shared_ptr<ReceiveRing> ring = std::make_shared<ReceiveRing>();
+
+        size_t offset = 0;
+        u32 numPackets = 0;
+        while (offset < stream.size())
+        {
+            ring->Reclaim();
+
+            size_t size = std::min(std::min(ring->GetContiguousSpace(), static_cast<size_t>(DECODER_BENCHMARK_CHUNK_SIZE)), stream.size() - offset);
+            std::memcpy(ring->GetWritePointer(), stream.data() + offset, size);
+            ring->SkipWrite(size);
+            offset += size;
+
+            PacketStreamResult result = PacketStreamDecoder<RECEIVE_RING_MAX_PAYLOAD_SIZE>::Decode(*ring, [&ring, &checksum](const PacketHeader& header)
+            {
+                if (!ring->HasFreeSlot())
+                    return false;
+
+                std::shared_ptr<NetPacket> packet = ring->Frame(header);
+                checksum += packet->payload->GetDataPointer()[0];
+                return true;
+            }, numPackets);
+
+            if (result != PacketStreamResult::NEED_MORE_DATA)
+            {
+                printf("Ring decode failed (result %u after %u packets)\n", static_cast<u32>(result), numPackets);
+                return false;
+            }
+        }
+
+        if (numPackets != numExpectedPackets)
+        {
+            printf("Ring decode failed (%u of %u packets)\n", numPackets, numExpectedPackets);
+            return false;
+        }
+    }
+
+    f64 seconds = GetElapsedSeconds(start);
+    PrintResult("ring", static_cast<u64>(numExpectedPackets) * numIterations, static_cast<u64>(stream.size()) * numIterations, seconds);
+
+    benchmarkChecksum += checksum;
+    return true;
+}
+
+i32 main(i32 argc, char* argv[])
+{
+    u32 numPackets = argc > 1 ? static_cast<u32>(std::strtoul(argv[1], nullptr, 10)) : DECODER_BENCHMARK_NUM_PACKETS;
+    u32 numIterations = argc > 2 ? static_cast<u32>(std::strtoul(argv[2], nullptr, 10)) : DECODER_BENCHMARK_NUM_ITERATIONS;
+    if (numPackets == 0 || numIterations == 0)
+    {
+        printf("Usage: %s [numPackets] [numIterations]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<u8> stream = BuildStream(numPackets);
+    printf("Decoding %u packets (%.2f MB) %u times\n", numPackets, stream.size() / (1024.0 * 1024.0), numIterations);
+
+    if (!BenchmarkFlat(stream, numPackets, numIterations))
+        return 1;
+
+    if (!BenchmarkRing(stream, numPackets, numIterations))
+        return 1;
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,393 @@
+#include <NovusTypes.h>
+#include <Utils/ByteBuffer.h>
+#include <Utils/ConcurrentQueue.h>
+#include <Networking/NetClient.h>
+#include <Networking/NetServer.h>
+#include <Networking/NetPacket.h>
+#include "../Network/NetworkIOThreadPool.h"
+#include "../Network/NetworkChannel.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/socket.h>
+#endif
+
+// Runs the network I/O threads against synthetic loopback connections, once on epoll and once on io_uring
+// Every round each connection sends one movement packet that has to reach the tick, then the tick sends one update to every connection
+// Afterwards every connection stays open but silent while the tick keeps polling, the CPU time the process burns in that window is what idle connections cost
+// Usage: novus-world-network-benchmark [numRounds] [numConnections...]
+
+#define NETWORK_BENCHMARK_NUM_ROUNDS 50
+#define NETWORK_BENCHMARK_PORT 4510
+#define NETWORK_BENCHMARK_TIMEOUT_S 30.0
+#define NETWORK_BENCHMARK_RESERVED_HANDLES 64
+
+// How long the connections sit idle, polled at the world server's tick rate
+#define NETWORK_BENCHMARK_IDLE_TIME_S 2.0
+#define NETWORK_BENCHMARK_IDLE_TICK_MS 33
+
+struct BenchmarkConnection
+{
+    std::shared_ptr<NetClient> client;
+    std::shared_ptr<NetworkChannel> channel;
+};
+
+static moodycamel::ConcurrentQueue<std::shared_ptr<NetClient>> acceptedClients(1024);
+
+static bool HandleConnect(std::shared_ptr<NetClient> netClient)
+{
+    std::shared_ptr<NetSocket> socket = netClient->GetSocket();
+    socket->SetBlockingState(false);
+    socket->SetNoDelayState(true);
+
+    acceptedClients.enqueue(std::move(netClient));
+    return true;
+}
+
+static f64 GetElapsedSeconds(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<f64>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+#ifdef __linux__
+// 10k connections are 20k handles on our side of the loopback alone, returns how many we may open
+static u64 RaiseHandleLimit()
+{
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+        return 0;
+
+    if (limit.rlim_cur < limit.rlim_max)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+        getrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    return static_cast<u64>(limit.rlim_cur);
+}
+
+// User and system time of every thread in the process
+static f64 GetProcessCPUSeconds()
+{
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0.0;
+
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000000.0;
+}
+
+static bool Connect(u32 numConnections, std::vector<BenchmarkConnection>& connections)
+{
+    connections.resize(numConnections);
+
+    for (u32 i = 0; i < numConnections; i++)
+    {
+        std::shared_ptr<NetClient> client = std::make_shared<NetClient>();
+        client->Init(NetSocket::Mode::TCP);
+
+        if (!client->Connect("127.0.0.1", NETWORK_BENCHMARK_PORT))
+        {
+            printf("Failed to connect %u of %u connections\n", i, numConnections);
+            return false;
+        }
+
+        client->GetSocket()->SetBlockingState(false);
+        client->GetSocket()->SetNoDelayState(true);
+        connections[i].client = std::move(client);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    u32 numAccepted = 0;
+    while (numAccepted < numConnections)
+    {
+        std::shared_ptr<NetClient> netClient;
+        if (!acceptedClients.try_dequeue(netClient))
+        {
+            if (GetElapsedSeconds(start) > NETWORK_BENCHMARK_TIMEOUT_S)
+            {
+                printf("Only %u of %u connections were accepted\n", numAccepted, numConnections);
+                return false;
+            }
+
+            std::this_thread::yield();
+            continue;
+        }
+
+        // Which client a server side socket belongs to doesn't matter, every client sends the same
+        connections[numAccepted].channel = std::make_shared<NetworkChannel>(netClient, numAccepted);
+        connections[numAccepted].channel->isAuthenticated = true;
+        numAccepted++;
+    }
+
+    return true;
+}
+
+static void Disconnect(NetworkIOThreadPool& pool, std::vector<BenchmarkConnection>& connections)
+{
+    for (BenchmarkConnection& connection : connections)
+    {
+        if (connection.channel)
+        {
+            pool.Remove(connection.channel);
+        }
+
+        if (connection.client)
+        {
+            connection.client->Close();
+        }
+    }
+
+    pool.Stop();
+    connections.clear();
+}
+
+// Every connection sends one packet, returns once the tick has all of them
+static bool RunReceiveRound(NetworkIOThreadPool& pool, std::vector<BenchmarkConnection>& connections, std::vector<u64>& readyTokens)
+{
+    u8 packet[sizeof(PacketHeader) + sizeof(f32) * 9] = { };
+    PacketHeader header = { Opcode::MSG_MOVE_ENTITY, static_cast<u16>(sizeof(f32) * 9) };
+    std::memcpy(packet, &header, sizeof(PacketHeader));
+
+    for (BenchmarkConnection& connection : connections)
+    {
+        i32 handle = static_cast<i32>(connection.client->GetSocket()->GetSocket());
+        if (send(handle, packet, sizeof(packet), MSG_NOSIGNAL) != sizeof(packet))
+        {
+            printf("Failed to send from a synthetic connection\n");
+            return false;
+        }
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    size_t numReceived = 0;
+    while (numReceived < connections.size())
+    {
+        pool.GetReadyTokens(readyTokens);
+
+        for (u64 token : readyTokens)
+        {
+            NetworkChannel& channel = *connections[token].channel;
+            channel.isPendingTick = false;
+
+            std::shared_ptr<NetPacket> netPacket;
+            while (channel.packetQueue.try_dequeue(netPacket))
+            {
+                numReceived++;
+            }
+
+            if (!channel.IsConnected())
+            {
+                printf("A synthetic connection was dropped\n");
+                return false;
+            }
+        }
+
+        if (readyTokens.empty())
+        {
+            if (GetElapsedSeconds(start) > NETWORK_BENCHMARK_TIMEOUT_S)
+            {
+                printf("Only %llu of %llu packets arrived\n", static_cast<u64>(numReceived), static_cast<u64>(connections.size()));
+                return false;
+            }
+
+            std::this_thread::yield();
+        }
+    }
+
+    return true;
+}
+
+// Nobody sends anything, the tick keeps asking for ready connections like it does every frame, returns the CPU seconds spent per wall clock second
+static bool RunIdle(NetworkIOThreadPool& pool, std::vector<BenchmarkConnection>& connections, std::vector<u64>& readyTokens, f64& cpuSecondsPerSecond)
+{
+    f64 cpuStart = GetProcessCPUSeconds();
+    auto start = std::chrono::high_resolution_clock::now();
+
+    while (GetElapsedSeconds(start) < NETWORK_BENCHMARK_IDLE_TIME_S)
+    {
+        pool.GetReadyTokens(readyTokens);
+        if (!readyTokens.empty())
+        {
+            printf("%llu connections woke the tick without sending anything\n", static_cast<u64>(readyTokens.size()));
+            return false;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(NETWORK_BENCHMARK_IDLE_TICK_MS));
+    }
+
+    for (BenchmarkConnection& connection : connections)
+    {
+        if (!connection.channel->IsConnected())
+        {
+            printf("A synthetic connection was dropped while idle\n");
+            return false;
+        }
+    }
+
+    cpuSecondsPerSecond = (GetProcessCPUSeconds() - cpuStart) / GetElapsedSeconds(start);
+    return true;
+}
+
+// The tick hands the same update to every connection, returns once the I/O threads wrote all of it
+static bool RunSendRound(std::vector<BenchmarkConnection>& connections)
+{
+    std::shared_ptr<Bytebuffer> buffer = Bytebuffer::Borrow<64>();
+    buffer->Put(Opcode::SMSG_UPDATE_ENTITY);
+    buffer->PutU16(sizeof(f32) * 9);
+    buffer->writtenData += sizeof(f32) * 9;
+
+    PacketSegment segment(buffer);
+    for (BenchmarkConnection& connection : connections)
+    {
+        connection.channel->Send(segment);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for (BenchmarkConnection& connection : connections)
+    {
+        while (connection.channel->pendingSendBytes.load(std::memory_order_acquire) > 0)
+        {
+            if (GetElapsedSeconds(start) > NETWORK_BENCHMARK_TIMEOUT_S)
+            {
+                printf("Sends didn't finish\n");
+                return false;
+            }
+
+            std::this_thread::yield();
+        }
+    }
+
+    return true;
+}
+
+static bool Run(NetworkIOBackend backend, u32 numConnections, u32 numRounds)
+{
+    NetworkIOThreadPool pool;
+    if (!pool.Start(NETWORK_IO_THREAD_COUNT, backend))
+    {
+        printf("Failed to start the network I/O threads\n");
+        return false;
+    }
+
+    // Asked for io_uring but got epoll, the numbers would only repeat the epoll run
+    if (backend == NetworkIOBackend::URING && pool.GetBackend() != NetworkIOBackend::URING)
+    {
+        printf("%6u connections  io_uring  unavailable (built without WORLD_ENABLE_IO_URING or unsupported by the kernel)\n", numConnections);
+        pool.Stop();
+        return true;
+    }
+
+    std::vector<BenchmarkConnection> connections;
+    if (!Connect(numConnections, connections))
+    {
+        Disconnect(pool, connections);
+        return false;
+    }
+
+    for (BenchmarkConnection& connection : connections)
+    {
+        pool.Add(connection.channel);
+    }
+
+    std::vector<u64> readyTokens;
+
+    // One round to get every connection's first receive armed and every ring allocated
+    bool isSuccessful = RunReceiveRound(pool, connections, readyTokens) && RunSendRound(connections);
+
+    f64 receiveSeconds = 0.0;
+    f64 sendSeconds = 0.0;
+    for (u32 round = 0; round < numRounds && isSuccessful; round++)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        isSuccessful = RunReceiveRound(pool, connections, readyTokens);
+        receiveSeconds += GetElapsedSeconds(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        isSuccessful = isSuccessful && RunSendRound(connections);
+        sendSeconds += GetElapsedSeconds(start);
+    }
+
+    f64 idleCPUSecondsPerSecond = 0.0;
+    isSuccessful = isSuccessful && RunIdle(pool, connections, readyTokens, idleCPUSecondsPerSecond);
+
+    if (isSuccessful)
+    {
+        u64 numPackets = static_cast<u64>(numConnections) * numRounds;
+        printf("%6u connections  %-8s  receive %9.1f us/round %8.2f M packets/s  send %9.1f us/round %8.2f M packets/s  idle %7.2f ms CPU/s %8.1f ns CPU/s per connection\n", numConnections, backend == NetworkIOBackend::URING ? "io_uring" : "epoll",
+            (receiveSeconds * 1000000.0) / numRounds, (numPackets / receiveSeconds) / 1000000.0,
+            (sendSeconds * 1000000.0) / numRounds, (numPackets / sendSeconds) / 1000000.0,
+            idleCPUSecondsPerSecond * 1000.0, (idleCPUSecondsPerSecond * 1000000000.0) / numConnections);
+    }
+
+    Disconnect(pool, connections);
+    return isSuccessful;
+}
+#endif // __linux__
+
+i32 main(i32 argc, char* argv[])
+{
+#ifdef __linux__
+    u32 numRounds = argc > 1 ? static_cast<u32>(std::strtoul(argv[1], nullptr, 10)) : NETWORK_BENCHMARK_NUM_ROUNDS;
+    if (numRounds == 0)
+    {
+        printf("Usage: %s [numRounds] [numConnections...]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<u32> connectionCounts;
+    for (i32 i = 2; i < argc; i++)
+    {
+        connectionCounts.push_back(static_cast<u32>(std::strtoul(argv[i], nullptr, 10)));
+    }
+
+    if (connectionCounts.empty())
+    {
+        connectionCounts = { 1000, 5000, 10000 };
+    }
+
+    u64 handleLimit = RaiseHandleLimit();
+
+    std::shared_ptr<NetServer> server = std::make_shared<NetServer>();
+    server->SetOnConnectCallback(HandleConnect);
+    if (!server->Init(NetSocket::Mode::TCP, "127.0.0.1", NETWORK_BENCHMARK_PORT))
+    {
+        printf("Failed to listen on port %u\n", NETWORK_BENCHMARK_PORT);
+        return 1;
+    }
+
+    printf("%u rounds on %u network I/O threads\n", numRounds, NETWORK_IO_THREAD_COUNT);
+
+    for (u32 numConnections : connectionCounts)
+    {
+        // Both ends of every connection plus the listener, pollers and wake handles
+        if (static_cast<u64>(numConnections) * 2 + NETWORK_BENCHMARK_RESERVED_HANDLES > handleLimit)
+        {
+            printf("%6u connections  skipped, the handle limit of %llu is too low\n", numConnections, handleLimit);
+            continue;
+        }
+
+        if (!Run(NetworkIOBackend::EPOLL, numConnections, numRounds))
+            return 1;
+
+        if (!Run(NetworkIOBackend::URING, numConnections, numRounds))
+            return 1;
+    }
+
+    return 0;
+#else
+    printf("The network I/O threads only run on Linux\n");
+    return 0;
+#endif // __linux__
+}
\ No newline at end of file
@@ -0,0 +1,281 @@
+#include <NovusTypes.h>
+#include <Utils/ConcurrentQueue.h>
+#include <Networking/NetClient.h>
+#include <Networking/NetServer.h>
+#include <Networking/NetPacket.h>
+#include "../ECS/Components/Network/ConnectionDeferredSingleton.h"
+#include "../Network/NetworkIOThreadPool.h"
+#include "../Network/NetworkChannel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/socket.h>
+#endif
+
+// Reconnects every client at once, the way they all come back after a world server restart, and ticks through it
+// Every client sends its logon challenge right after connecting, the storm is over once the tick has all of them
+// The tick admits new connections like ConnectionDeferredSystem, once with an admission limit per tick and once taking everyone waiting
+// Usage: novus-world-reconnect-benchmark [numConnections] [admissionsPerTick...] (0 admits everyone waiting)
+
+#define RECONNECT_BENCHMARK_NUM_CONNECTIONS 10000
+#define RECONNECT_BENCHMARK_PORT 4511
+#define RECONNECT_BENCHMARK_TICK_MS 33
+#define RECONNECT_BENCHMARK_TIMEOUT_S 60.0
+#define RECONNECT_BENCHMARK_RESERVED_HANDLES 64
+
+// Username plus the 256 byte SRP public key, about what a real logon challenge carries
+#define RECONNECT_BENCHMARK_CHALLENGE_SIZE 264
+
+static moodycamel::ConcurrentQueue<std::shared_ptr<NetClient>> newConnectionQueue(1024);
+
+static bool HandleConnect(std::shared_ptr<NetClient> netClient)
+{
+    std::shared_ptr<NetSocket> socket = netClient->GetSocket();
+    socket->SetBlockingState(false);
+    socket->SetNoDelayState(true);
+
+    newConnectionQueue.enqueue(std::move(netClient));
+    return true;
+}
+
+static f64 GetElapsedSeconds(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<f64>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+#ifdef __linux__
+// 10k connections are 20k handles on our side of the loopback alone, returns how many we may open
+static u64 RaiseHandleLimit()
+{
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+        return 0;
+
+    if (limit.rlim_cur < limit.rlim_max)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+        getrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    return static_cast<u64>(limit.rlim_cur);
+}
+
+// The client side of the storm, connects everyone as fast as it can and sends each logon challenge right away
+static void RunClients(u32 numConnections, std::vector<std::shared_ptr<NetClient>>& clients, std::atomic<bool>& isFailed)
+{
+    u8 packet[sizeof(PacketHeader) + RECONNECT_BENCHMARK_CHALLENGE_SIZE] = { };
+    PacketHeader header = { Opcode::CMSG_LOGON_CHALLENGE, static_cast<u16>(RECONNECT_BENCHMARK_CHALLENGE_SIZE) };
+    std::memcpy(packet, &header, sizeof(PacketHeader));
+
+    clients.reserve(numConnections);
+    for (u32 i = 0; i < numConnections; i++)
+    {
+        std::shared_ptr<NetClient> client = std::make_shared<NetClient>();
+        client->Init(NetSocket::Mode::TCP);
+
+        if (!client->Connect("127.0.0.1", RECONNECT_BENCHMARK_PORT))
+        {
+            printf("Failed to connect %u of %u connections\n", i, numConnections);
+            isFailed = true;
+            return;
+        }
+
+        i32 handle = static_cast<i32>(client->GetSocket()->GetSocket());
+        if (send(handle, packet, sizeof(packet), MSG_NOSIGNAL) != sizeof(packet))
+        {
+            printf("Failed to send a logon challenge\n");
+            isFailed = true;
+            return;
+        }
+
+        clients.push_back(std::move(client));
+    }
+}
+
+static bool Run(u32 numConnections, u32 admissionsPerTick)
+{
+    NetworkIOThreadPool pool;
+    if (!pool.Start(NETWORK_IO_THREAD_COUNT))
+    {
+        printf("Failed to start the network I/O threads\n");
+        return false;
+    }
+
+    std::vector<std::shared_ptr<NetClient>> clients;
+    std::atomic<bool> isFailed = { false };
+
+    std::vector<std::shared_ptr<NetworkChannel>> channels;
+    channels.reserve(numConnections);
+
+    std::vector<std::shared_ptr<NetClient>> admittedClients;
+    std::vector<u64> readyTokens;
+
+    u32 numTicks = 0;
+    u32 numChallenges = 0;
+    f64 longestTickSeconds = 0.0;
+    f64 totalTickSeconds = 0.0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::thread clientThread(RunClients, numConnections, std::ref(clients), std::ref(isFailed));
+
+    while (numChallenges < numConnections && !isFailed)
+    {
+        if (GetElapsedSeconds(start) > RECONNECT_BENCHMARK_TIMEOUT_S)
+        {
+            printf("Only %u of %u logon challenges arrived, %u connections were admitted\n", numChallenges, numConnections, static_cast<u32>(channels.size()));
+            isFailed = true;
+            break;
+        }
+
+        auto tickStart = std::chrono::high_resolution_clock::now();
+
+        // Same as ConnectionDeferredSystem, one bulk dequeue of at most admissionsPerTick connections
+        size_t numWaiting = newConnectionQueue.size_approx();
+        if (numWaiting > 0)
+        {
+            admittedClients.resize(admissionsPerTick > 0 ? admissionsPerTick : numWaiting);
+            size_t numAdmitted = newConnectionQueue.try_dequeue_bulk(admittedClients.begin(), admittedClients.size());
+
+            for (size_t i = 0; i < numAdmitted; i++)
+            {
+                std::shared_ptr<NetworkChannel> channel = std::make_shared<NetworkChannel>(std::move(admittedClients[i]), channels.size());
+                pool.Add(channel);
+                channels.push_back(std::move(channel));
+            }
+        }
+
+        pool.GetReadyTokens(readyTokens);
+        for (u64 token : readyTokens)
+        {
+            NetworkChannel& channel = *channels[token];
+            channel.isPendingTick = false;
+
+            std::shared_ptr<NetPacket> netPacket;
+            while (channel.packetQueue.try_dequeue(netPacket))
+            {
+                numChallenges++;
+            }
+
+            if (!channel.IsConnected())
+            {
+                printf("A reconnecting client was dropped\n");
+                isFailed = true;
+                break;
+            }
+        }
+
+        f64 tickSeconds = GetElapsedSeconds(tickStart);
+        longestTickSeconds = std::max(longestTickSeconds, tickSeconds);
+        totalTickSeconds += tickSeconds;
+        numTicks++;
+
+        if (tickSeconds * 1000.0 < RECONNECT_BENCHMARK_TICK_MS)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(static_cast<i64>((RECONNECT_BENCHMARK_TICK_MS - tickSeconds * 1000.0) * 1000.0)));
+        }
+    }
+
+    f64 stormSeconds = GetElapsedSeconds(start);
+    clientThread.join();
+
+    bool isSuccessful = !isFailed;
+    if (isSuccessful)
+    {
+        char limitName[16];
+        if (admissionsPerTick > 0)
+        {
+            snprintf(limitName, sizeof(limitName), "%u/tick", admissionsPerTick);
+        }
+        else
+        {
+            snprintf(limitName, sizeof(limitName), "unlimited");
+        }
+
+        printf("%6u connections  admit %-10s  %8.2f s until every challenge arrived  %5u ticks  longest tick %8.2f ms  average tick %7.3f ms\n", numConnections, limitName,
+            stormSeconds, numTicks, longestTickSeconds * 1000.0, (totalTickSeconds * 1000.0) / numTicks);
+    }
+
+    for (std::shared_ptr<NetworkChannel>& channel : channels)
+    {
+        pool.Remove(channel);
+    }
+    pool.Stop();
+
+    for (std::shared_ptr<NetClient>& client : clients)
+    {
+        client->Close();
+    }
+
+    // Whatever is left over was never admitted, a timed out run mustn't leak it into the next one
+    std::shared_ptr<NetClient> netClient;
+    while (newConnectionQueue.try_dequeue(netClient))
+    {
+        netClient->Close();
+    }
+
+    return isSuccessful;
+}
+#endif // __linux__
+
+i32 main(i32 argc, char* argv[])
+{
+#ifdef __linux__
+    u32 numConnections = argc > 1 ? static_cast<u32>(std::strtoul(argv[1], nullptr, 10)) : RECONNECT_BENCHMARK_NUM_CONNECTIONS;
+    if (numConnections == 0)
+    {
+        printf("Usage: %s [numConnections] [admissionsPerTick...]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<u32> admissionLimits;
+    for (i32 i = 2; i < argc; i++)
+    {
+        admissionLimits.push_back(static_cast<u32>(std::strtoul(argv[i], nullptr, 10)));
+    }
+
+    if (admissionLimits.empty())
+    {
+        admissionLimits = { CONNECTION_ADMISSIONS_PER_TICK, 0 };
+    }
+
+    // Both ends of every connection plus the listener, pollers and wake handles
+    u64 handleLimit = RaiseHandleLimit();
+    if (static_cast<u64>(numConnections) * 2 + RECONNECT_BENCHMARK_RESERVED_HANDLES > handleLimit)
+    {
+        printf("The handle limit of %llu is too low for %u connections\n", static_cast<unsigned long long>(handleLimit), numConnections);
+        return 1;
+    }
+
+    std::shared_ptr<NetServer> server = std::make_shared<NetServer>();
+    server->SetOnConnectCallback(HandleConnect);
+    if (!server->Init(NetSocket::Mode::TCP, "127.0.0.1", RECONNECT_BENCHMARK_PORT))
+    {
+        printf("Failed to listen on port %u\n", RECONNECT_BENCHMARK_PORT);
+        return 1;
+    }
+
+    printf("%u clients reconnecting on %u network I/O threads, unauthenticated connections get a %u byte receive ring\n", numConnections, NETWORK_IO_THREAD_COUNT, RECEIVE_RING_HANDSHAKE_SIZE);
+
+    for (u32 admissionsPerTick : admissionLimits)
+    {
+        if (!Run(numConnections, admissionsPerTick))
+            return 1;
+    }
+
+    return 0;
+#else
+    printf("The network I/O threads only run on Linux\n");
+    return 0;
+#endif // __linux__
+}
\ No newline at end of file
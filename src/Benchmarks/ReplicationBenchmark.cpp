@@ -0,0 +1,293 @@
+#include <NovusTypes.h>
+#include <Utils/ByteBuffer.h>
+#include <Networking/NetPacket.h>
+#include <Gameplay/Network/PacketWriter.h>
+#include <Gameplay/ECS/Components/Transform.h>
+#include <entt.hpp>
+#include "../Network/MovementReplication.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// Replays entity movement through the full float SMSG_UPDATE_ENTITY and through SMSG_UPDATE_ENTITY_QUANTIZED and reports the bytes per entity update of both
+// Every quantized update is applied to a client side copy again and checked against the state it was built from
+// Usage: novus-world-replication-benchmark [numEntities] [numSeconds]
+//        novus-world-replication-benchmark <session file>
+// A session file has one movement sample per line: time entity x y z rotationX rotationY rotationZ (seconds, yards, degrees)
+
+#define REPLICATION_BENCHMARK_NUM_ENTITIES 1000
+#define REPLICATION_BENCHMARK_NUM_SECONDS 60
+#define REPLICATION_BENCHMARK_TICK_TIME (1.0f / 30.0f)
+
+// Synthetic entities run at this speed, every tick they may stop, start again or turn
+#define REPLICATION_BENCHMARK_RUN_SPEED 7.0f
+#define REPLICATION_BENCHMARK_TOGGLE_CHANCE 0.01f
+#define REPLICATION_BENCHMARK_TURN_CHANCE 0.05f
+
+// Everything the encoders produce ends up here, so the compiler can't drop the work
+static volatile u64 benchmarkChecksum = 0;
+
+// A tick on which the entity's transform was dirty, what UpdateEntityPositionSystem sees
+struct MovementSample
+{
+    f32 time;
+    u32 entity;
+    Transform transform;
+};
+
+static std::vector<MovementSample> BuildSession(u32 numEntities, u32 numSeconds)
+{
+    struct Walker
+    {
+        vec3 position;
+        f32 heading;
+        bool isMoving;
+    };
+
+    std::mt19937 random(1337);
+    std::uniform_real_distribution<f32> positionDistribution(-500.0f, 500.0f);
+    std::uniform_real_distribution<f32> chanceDistribution(0.0f, 1.0f);
+    std::uniform_real_distribution<f32> turnDistribution(-45.0f, 45.0f);
+
+    std::vector<Walker> walkers(numEntities);
+    for (Walker& walker : walkers)
+    {
+        walker.position = vec3(positionDistribution(random), positionDistribution(random), 0.0f);
+        walker.heading = chanceDistribution(random) * 360.0f;
+        walker.isMoving = chanceDistribution(random) < 0.5f;
+    }
+
+    u32 numTicks = static_cast<u32>(numSeconds / REPLICATION_BENCHMARK_TICK_TIME);
+
+    std::vector<MovementSample> samples;
+    samples.reserve(static_cast<size_t>(numTicks) * numEntities / 2);
+
+    for (u32 tick = 0; tick < numTicks; tick++)
+    {
+        f32 time = tick * REPLICATION_BENCHMARK_TICK_TIME;
+
+        for (u32 i = 0; i < numEntities; i++)
+        {
+            Walker& walker = walkers[i];
+
+            bool isDirty = tick == 0;
+            if (chanceDistribution(random) < REPLICATION_BENCHMARK_TOGGLE_CHANCE)
+            {
+                walker.isMoving = !walker.isMoving;
+            }
+
+            if (walker.isMoving)
+            {
+                if (chanceDistribution(random) < REPLICATION_BENCHMARK_TURN_CHANCE)
+                {
+                    walker.heading = std::fmod(walker.heading + turnDistribution(random) + 360.0f, 360.0f);
+                }
+
+                f32 radians = walker.heading * (3.14159265f / 180.0f);
+                walker.position.x += std::cos(radians) * REPLICATION_BENCHMARK_RUN_SPEED * REPLICATION_BENCHMARK_TICK_TIME;
+                walker.position.y += std::sin(radians) * REPLICATION_BENCHMARK_RUN_SPEED * REPLICATION_BENCHMARK_TICK_TIME;
+                isDirty = true;
+            }
+
+            if (!isDirty)
+                continue;
+
+            MovementSample& sample = samples.emplace_back();
+            sample.time = time;
+            sample.entity = i;
+            sample.transform.position = walker.position;
+            sample.transform.rotation = vec3(0.0f, 0.0f, walker.heading);
+            sample.transform.scale = vec3(1.0f, 1.0f, 1.0f);
+        }
+    }
+
+    return samples;
+}
+
+static bool LoadSession(const char* path, std::vector<MovementSample>& samples)
+{
+    FILE* file = fopen(path, "r");
+    if (!file)
+    {
+        printf("Failed to open %s\n", path);
+        return false;
+    }
+
+    MovementSample sample;
+    sample.transform.scale = vec3(1.0f, 1.0f, 1.0f);
+
+    vec3& position = sample.transform.position;
+    vec3& rotation = sample.transform.rotation;
+    while (fscanf(file, "%f %u %f %f %f %f %f %f", &sample.time, &sample.entity, &position.x, &position.y, &position.z, &rotation.x, &rotation.y, &rotation.z) == 8)
+    {
+        samples.push_back(sample);
+    }
+
+    fclose(file);
+
+    // The replay needs them in the order the ticks sent them
+    std::stable_sort(samples.begin(), samples.end(), [](const MovementSample& a, const MovementSample& b) { return a.time < b.time; });
+    return true;
+}
+
+static f64 GetElapsedSeconds(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<f64>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// Every update as it went out before replication was quantized
+static bool BenchmarkFull(const std::vector<MovementSample>& samples, u64& numBytes)
+{
+    numBytes = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (const MovementSample& sample : samples)
+    {
+        std::shared_ptr<Bytebuffer> buffer = nullptr;
+        if (!PacketWriter::SMSG_UPDATE_ENTITY(buffer, static_cast<entt::entity>(sample.entity), sample.transform))
+        {
+            printf("Failed to build SMSG_UPDATE_ENTITY\n");
+            return false;
+        }
+
+        numBytes += buffer->writtenData;
+    }
+
+    f64 seconds = GetElapsedSeconds(start);
+    printf("%-10s %8.2f bytes/update %10llu bytes %8.2f ns/update\n", "full", static_cast<f64>(numBytes) / samples.size(), numBytes, (seconds * 1000000000.0) / samples.size());
+    return true;
+}
+
+// What UpdateEntityPositionSystem sends a single observer, its baselines move exactly like ReplicationComponent's
+static bool BenchmarkQuantized(const std::vector<MovementSample>& samples, u64 numFullBytes)
+{
+    struct Baseline
+    {
+        QuantizedTransform transform;
+        f32 keyframeTime;
+
+        // What the client ends up with after applying everything it received
+        QuantizedTransform clientTransform;
+    };
+
+    std::unordered_map<u32, Baseline> baselines;
+    baselines.reserve(REPLICATION_BENCHMARK_NUM_ENTITIES);
+
+    u64 numBytes = 0;
+    u64 numDeltaBytes = 0;
+    u64 numKeyframes = 0;
+    u64 numDeltas = 0;
+    u64 numRedundant = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (const MovementSample& sample : samples)
+    {
+        entt::entity entity = static_cast<entt::entity>(sample.entity);
+        QuantizedTransform transform = QuantizedTransform::FromTransform(sample.transform);
+
+        // The first sample stands in for SMSG_CREATE_ENTITY, both encodings have to send that one in full
+        auto itr = baselines.find(sample.entity);
+        if (itr == baselines.end())
+        {
+            baselines[sample.entity] = { transform, sample.time, transform };
+            numRedundant++;
+            continue;
+        }
+
+        Baseline& baseline = itr->second;
+        bool isKeyframe = sample.time - baseline.keyframeTime >= MOVEMENT_KEYFRAME_TIME;
+        if (!isKeyframe && baseline.transform == transform)
+        {
+            numRedundant++;
+            continue;
+        }
+
+        std::shared_ptr<Bytebuffer> buffer = nullptr;
+        if (!MovementReplication::WriteUpdate(buffer, entity, isKeyframe ? nullptr : &baseline.transform, transform))
+        {
+            printf("Failed to build SMSG_UPDATE_ENTITY_QUANTIZED\n");
+            return false;
+        }
+
+        const u8* payload = buffer->GetDataPointer() + sizeof(PacketHeader);
+        size_t payloadSize = buffer->writtenData - sizeof(PacketHeader);
+        if (!MovementReplication::ApplyUpdate(payload, payloadSize, baseline.clientTransform) || baseline.clientTransform != transform)
+        {
+            printf("Entity %u decoded to a different state at %.3f s\n", sample.entity, sample.time);
+            return false;
+        }
+
+        if (isKeyframe)
+        {
+            baseline.keyframeTime = sample.time;
+            numKeyframes++;
+        }
+        else
+        {
+            numDeltas++;
+            numDeltaBytes += buffer->writtenData;
+        }
+
+        baseline.transform = transform;
+        numBytes += buffer->writtenData;
+        benchmarkChecksum += payload[4];
+    }
+
+    f64 seconds = GetElapsedSeconds(start);
+
+    // Per sample like the full encoding, the redundant ones cost nothing
+    u64 numUpdates = samples.size();
+    printf("%-10s %8.2f bytes/update %10llu bytes %8.2f ns/update, %.1f%% of full\n", "quantized", static_cast<f64>(numBytes) / numUpdates, numBytes, (seconds * 1000000000.0) / numUpdates, numFullBytes > 0 ? (100.0 * numBytes) / numFullBytes : 0.0);
+    printf("%-10s %llu keyframes, %llu deltas (%.2f bytes each), %llu redundant\n", "", numKeyframes, numDeltas, numDeltas > 0 ? static_cast<f64>(numDeltaBytes) / numDeltas : 0.0, numRedundant);
+    return true;
+}
+
+i32 main(i32 argc, char* argv[])
+{
+    std::vector<MovementSample> samples;
+
+    // Anything that isn't a number is a recorded session
+    char* end = nullptr;
+    if (argc > 1 && (std::strtoul(argv[1], &end, 10), *end != '\0'))
+    {
+        if (!LoadSession(argv[1], samples))
+            return 1;
+
+        printf("Replaying %llu movement samples from %s\n", static_cast<u64>(samples.size()), argv[1]);
+    }
+    else
+    {
+        u32 numEntities = argc > 1 ? static_cast<u32>(std::strtoul(argv[1], nullptr, 10)) : REPLICATION_BENCHMARK_NUM_ENTITIES;
+        u32 numSeconds = argc > 2 ? static_cast<u32>(std::strtoul(argv[2], nullptr, 10)) : REPLICATION_BENCHMARK_NUM_SECONDS;
+        if (numEntities == 0 || numSeconds == 0)
+        {
+            printf("Usage: %s [numEntities] [numSeconds] or %s <session file>\n", argv[0], argv[0]);
+            return 1;
+        }
+
+        samples = BuildSession(numEntities, numSeconds);
+        printf("Replaying %llu movement samples of %u synthetic entities over %u seconds\n", static_cast<u64>(samples.size()), numEntities, numSeconds);
+    }
+
+    if (samples.empty())
+    {
+        printf("Nothing to replay\n");
+        return 1;
+    }
+
+    u64 numFullBytes = 0;
+    if (!BenchmarkFull(samples, numFullBytes))
+        return 1;
+
+    if (!BenchmarkQuantized(samples, numFullBytes))
+        return 1;
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,282 @@
+#include <NovusTypes.h>
+#include <Containers/KDTree.h>
+#include <entt.hpp>
+#include "../Gameplay/Map/SpatialGrid.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Compares what the world server did every tick before SpatialGrid (rebuild a KD-tree from every entity) with what it does now (move the dirty entities in the grid)
+// Every tick a share of the entities moves, then every player looks for the entities around it the way UpdateEntityPositionSystem does
+// The radius queries are then run once more on the grid, one scalar query per player against the batched SIMD query
+// Usage: novus-world-spatial-benchmark [numTicks] [numEntities...]
+
+#define SPATIAL_BENCHMARK_NUM_TICKS 30
+#define SPATIAL_BENCHMARK_NUM_PLAYERS 1000
+
+// Entities are spread over a square this big (yards) around the map center, the share of them that moves each tick goes this far
+#define SPATIAL_BENCHMARK_AREA_SIZE 16000.0f
+#define SPATIAL_BENCHMARK_MOVING_SHARE 0.1f
+#define SPATIAL_BENCHMARK_MOVE_DISTANCE 7.0f
+
+// Same as UpdateEntityPositionSystem::SyncDistance
+#define SPATIAL_BENCHMARK_QUERY_DISTANCE 500.0f
+
+typedef KDPoint<f32, entt::entity, 2> Point2D;
+typedef KDTree<f32, entt::entity, 2> Tree2D;
+
+#if defined(__AVX2__)
+#define SPATIAL_BENCHMARK_KERNEL_NAME "avx2"
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SPATIAL_BENCHMARK_KERNEL_NAME "sse2"
+#else
+#define SPATIAL_BENCHMARK_KERNEL_NAME "scalar"
+#endif
+
+// Everything the queries find ends up here, so the compiler can't drop the work
+static volatile u64 benchmarkChecksum = 0;
+
+struct SpatialWorld
+{
+    std::vector<vec2> positions;
+    u32 numPlayers;
+};
+
+static SpatialWorld BuildWorld(u32 numEntities, std::mt19937& random)
+{
+    std::uniform_real_distribution<f32> positionDistribution(-SPATIAL_BENCHMARK_AREA_SIZE / 2.0f, SPATIAL_BENCHMARK_AREA_SIZE / 2.0f);
+
+    SpatialWorld world;
+    world.positions.resize(numEntities);
+    world.numPlayers = std::min(numEntities, static_cast<u32>(SPATIAL_BENCHMARK_NUM_PLAYERS));
+
+    for (vec2& position : world.positions)
+    {
+        position = vec2(positionDistribution(random), positionDistribution(random));
+    }
+
+    return world;
+}
+
+// Moves a random share of the entities and returns which ones, what TransformIsDirty would hold
+static void MoveEntities(SpatialWorld& world, std::mt19937& random, std::vector<u32>& dirtyEntities)
+{
+    std::uniform_int_distribution<u32> entityDistribution(0, static_cast<u32>(world.positions.size()) - 1);
+    std::uniform_real_distribution<f32> moveDistribution(-SPATIAL_BENCHMARK_MOVE_DISTANCE, SPATIAL_BENCHMARK_MOVE_DISTANCE);
+
+    u32 numMoving = static_cast<u32>(world.positions.size() * SPATIAL_BENCHMARK_MOVING_SHARE);
+    dirtyEntities.resize(numMoving);
+
+    for (u32& entity : dirtyEntities)
+    {
+        entity = entityDistribution(random);
+        world.positions[entity] += vec2(moveDistribution(random), moveDistribution(random));
+    }
+}
+
+static f64 GetElapsedSeconds(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<f64>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static void PrintResult(const char* name, const SpatialWorld& world, f64 updateSeconds, f64 querySeconds, u64 numResults, u32 numTicks)
+{
+    printf("%-8s %7u entities %10.3f ms/tick update %10.3f ms/tick query %10.1f results/query\n", name, static_cast<u32>(world.positions.size()), (updateSeconds * 1000.0) / numTicks, (querySeconds * 1000.0) / numTicks, static_cast<f64>(numResults) / (static_cast<u64>(numTicks) * world.numPlayers));
+}
+
+// Every tick the tree is built again from every entity, dirty or not
+static void BenchmarkTree(u32 numEntities, u32 numTicks)
+{
+    std::mt19937 random(1337);
+    SpatialWorld world = BuildWorld(numEntities, random);
+
+    std::vector<u32> dirtyEntities;
+    std::vector<Point2D> points;
+    std::vector<Point2D> results;
+
+    f64 updateSeconds = 0.0;
+    f64 querySeconds = 0.0;
+    u64 numResults = 0;
+
+    for (u32 tick = 0; tick < numTicks; tick++)
+    {
+        MoveEntities(world, random, dirtyEntities);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        points.clear();
+        points.reserve(numEntities);
+        for (u32 i = 0; i < numEntities; i++)
+        {
+            points.push_back(Point2D({ world.positions[i].x, world.positions[i].y }, static_cast<entt::entity>(i)));
+        }
+
+        Tree2D tree = Tree2D(points.begin(), points.end());
+        updateSeconds += GetElapsedSeconds(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        for (u32 player = 0; player < world.numPlayers; player++)
+        {
+            results.clear();
+            tree.GetWithinDistance({ world.positions[player].x, world.positions[player].y }, SPATIAL_BENCHMARK_QUERY_DISTANCE, static_cast<entt::entity>(player), results);
+            numResults += results.size();
+        }
+        querySeconds += GetElapsedSeconds(start);
+    }
+
+    PrintResult("kd-tree", world, updateSeconds, querySeconds, numResults, numTicks);
+    benchmarkChecksum += numResults;
+}
+
+// The grid is filled once, after that only the dirty entities are moved
+static void BenchmarkGrid(u32 numEntities, u32 numTicks)
+{
+    std::mt19937 random(1337);
+    SpatialWorld world = BuildWorld(numEntities, random);
+
+    // Several MB of cells, keep it off the stack
+    std::unique_ptr<SpatialGrid> grid = std::make_unique<SpatialGrid>();
+    for (u32 i = 0; i < numEntities; i++)
+    {
+        grid->Update(static_cast<entt::entity>(i), world.positions[i]);
+    }
+
+    std::vector<u32> dirtyEntities;
+    std::vector<entt::entity> results;
+
+    f64 updateSeconds = 0.0;
+    f64 querySeconds = 0.0;
+    u64 numResults = 0;
+
+    for (u32 tick = 0; tick < numTicks; tick++)
+    {
+        MoveEntities(world, random, dirtyEntities);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (u32 entity : dirtyEntities)
+        {
+            grid->Update(static_cast<entt::entity>(entity), world.positions[entity]);
+        }
+        updateSeconds += GetElapsedSeconds(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        for (u32 player = 0; player < world.numPlayers; player++)
+        {
+            results.clear();
+            grid->GetWithinDistance(world.positions[player], SPATIAL_BENCHMARK_QUERY_DISTANCE, static_cast<entt::entity>(player), results);
+            numResults += results.size();
+        }
+        querySeconds += GetElapsedSeconds(start);
+    }
+
+    PrintResult("grid", world, updateSeconds, querySeconds, numResults, numTicks);
+    benchmarkChecksum += numResults;
+}
+
+static void PrintQueryResult(const char* name, const SpatialWorld& world, f64 seconds, u64 numResults, u32 numTicks)
+{
+    u64 numQueries = static_cast<u64>(numTicks) * world.numPlayers;
+    printf("%-8s %7u entities %10.3f ms/tick query %10.1f ns/query %10.1f results/query\n", name, static_cast<u32>(world.positions.size()), (seconds * 1000.0) / numTicks, (seconds * 1000000000.0) / numQueries, static_cast<f64>(numResults) / numQueries);
+}
+
+// The per player query of ForEachWithinDistance against the batched GetWithinDistance, both gather the entity and squared distance of every match
+static void BenchmarkRadiusQueries(u32 numEntities, u32 numTicks)
+{
+    std::mt19937 random(1337);
+    SpatialWorld world = BuildWorld(numEntities, random);
+
+    std::unique_ptr<SpatialGrid> grid = std::make_unique<SpatialGrid>();
+    for (u32 i = 0; i < numEntities; i++)
+    {
+        grid->Update(static_cast<entt::entity>(i), world.positions[i]);
+    }
+
+    std::vector<vec2> queryPositions(world.positions.begin(), world.positions.begin() + world.numPlayers);
+    RadiusQueryResults results;
+
+    f64 scalarSeconds = 0.0;
+    f64 batchedSeconds = 0.0;
+    u64 numScalarResults = 0;
+    u64 numBatchedResults = 0;
+
+    for (u32 tick = 0; tick < numTicks; tick++)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        results.Clear();
+        results.offsets.push_back(0);
+        for (const vec2& position : queryPositions)
+        {
+            grid->ForEachWithinDistance(position, SPATIAL_BENCHMARK_QUERY_DISTANCE, [&results](entt::entity entity, f32 distanceSquared)
+            {
+                results.entities.push_back(entity);
+                results.distancesSquared.push_back(distanceSquared);
+            });
+            results.offsets.push_back(static_cast<u32>(results.entities.size()));
+        }
+        scalarSeconds += GetElapsedSeconds(start);
+        numScalarResults += results.entities.size();
+
+        start = std::chrono::high_resolution_clock::now();
+        grid->GetWithinDistance(queryPositions.data(), queryPositions.size(), SPATIAL_BENCHMARK_QUERY_DISTANCE, results);
+        batchedSeconds += GetElapsedSeconds(start);
+        numBatchedResults += results.entities.size();
+    }
+
+    PrintQueryResult("scalar", world, scalarSeconds, numScalarResults, numTicks);
+    PrintQueryResult(SPATIAL_BENCHMARK_KERNEL_NAME, world, batchedSeconds, numBatchedResults, numTicks);
+
+    if (numScalarResults != numBatchedResults)
+    {
+        printf("The batched queries found %llu entities, the scalar ones %llu\n", static_cast<unsigned long long>(numBatchedResults), static_cast<unsigned long long>(numScalarResults));
+    }
+
+    benchmarkChecksum += numScalarResults + numBatchedResults;
+}
+
+i32 main(i32 argc, char* argv[])
+{
+    u32 numTicks = argc > 1 ? static_cast<u32>(std::strtoul(argv[1], nullptr, 10)) : SPATIAL_BENCHMARK_NUM_TICKS;
+    if (numTicks == 0)
+    {
+        printf("Usage: %s [numTicks] [numEntities...]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<u32> entityCounts;
+    for (i32 i = 2; i < argc; i++)
+    {
+        entityCounts.push_back(static_cast<u32>(std::strtoul(argv[i], nullptr, 10)));
+    }
+
+    if (entityCounts.empty())
+    {
+        entityCounts = { 10000, 100000, 500000 };
+    }
+
+    printf("%u ticks, %.0f%% of the entities move every tick, %u players query %.0f yards\n", numTicks, SPATIAL_BENCHMARK_MOVING_SHARE * 100.0f, SPATIAL_BENCHMARK_NUM_PLAYERS, SPATIAL_BENCHMARK_QUERY_DISTANCE);
+
+    for (u32 numEntities : entityCounts)
+    {
+        if (numEntities == 0)
+            continue;
+
+        BenchmarkTree(numEntities, numTicks);
+        BenchmarkGrid(numEntities, numTicks);
+    }
+
+    printf("Radius queries of %u players on the grid\n", SPATIAL_BENCHMARK_NUM_PLAYERS);
+
+    for (u32 numEntities : entityCounts)
+    {
+        if (numEntities == 0)
+            continue;
+
+        BenchmarkRadiusQueries(numEntities, numTicks);
+    }
+
+    return 0;
+}
\ No newline at end of file
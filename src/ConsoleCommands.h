@@ -34,6 +34,11 @@
 
 #include "ConsoleCommands/QuitCommand.h"
 #include "ConsoleCommands/PingCommand.h"
+#include "ConsoleCommands/PayloadsCommand.h"
+#include "ConsoleCommands/QueuesCommand.h"
+#include "ConsoleCommands/DBLatencyCommand.h"
+#include "ConsoleCommands/AuthCommand.h"
+#include "ConsoleCommands/AccountsCommand.h"
 
 class ConsoleCommandHandler
 {
@@ -42,6 +47,11 @@ public:
     {
         RegisterCommand("quit"_h, &QuitCommand);
         RegisterCommand("ping"_h, &PingCommand);
+        RegisterCommand("payloads"_h, &PayloadsCommand);
+        RegisterCommand("queues"_h, &QueuesCommand);
+        RegisterCommand("dblatency"_h, &DBLatencyCommand);
+        RegisterCommand("auth"_h, &AuthCommand);
+        RegisterCommand("accounts"_h, &AccountsCommand);
     }
 
     void HandleCommand(EngineLoop& engineLoop, std::string& command)
@@ -0,0 +1,46 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <Utils/Message.h>
+#include "../EngineLoop.h"
+
+// "accounts" prints the account cache counters, "accounts invalidate <username>" drops a single account and "accounts clear" drops all of them
+void AccountsCommand(EngineLoop& engineLoop, std::vector<std::string> subCommands)
+{
+    std::string arguments;
+    for (const std::string& subCommand : subCommands)
+    {
+        if (!arguments.empty())
+        {
+            arguments += " ";
+        }
+
+        arguments += subCommand;
+    }
+
+    Message accountsMessage;
+    accountsMessage.code = MSG_IN_ACCOUNT_CACHE;
+    accountsMessage.message = subCommands.size() > 0 ? new std::string(arguments) : nullptr;
+    engineLoop.PassMessage(accountsMessage);
+}
\ No newline at end of file
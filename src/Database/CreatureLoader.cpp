@@ -0,0 +1,171 @@
+#include "CreatureLoader.h"
+#include "DBWorkerPool.h"
+#include <Database/DBConnection.h>
+#include <Utils/DebugHandler.h>
+#include <Utils/Timer.h>
+#include <entt.hpp>
+#include <Gameplay/ECS/Components/Transform.h>
+#include <Gameplay/ECS/Components/GameEntity.h>
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+// Creatures decoded by a DB worker, inserted into the registry in one go on the engine thread
+struct CreatureChunk
+{
+    std::vector<SnapshotCreature> creatures;
+};
+
+// Where the keyset walk over the creatures table is at, only touched on the engine thread
+struct CreatureLoader::Progress
+{
+    u32 numPagesDone = 0;
+
+    // Known once the last page (or the one that failed) is done, 0 until then
+    u32 numPages = 0;
+    bool didFail = false;
+};
+
+bool CreatureLoader::Load(DBConnection& connection, DBWorkerPool& workers, entt::registry& registry, std::vector<SnapshotCreature>& creatures)
+{
+    DebugHandler::PrintSuccess("Fetching Creatures...");
+    Timer timer;
+
+    std::shared_ptr<QueryResult> countResult = connection.Query("SELECT COUNT(*) FROM `creatures`;");
+    if (!countResult || !countResult->GetNextRow())
+    {
+        DebugHandler::PrintError("Failed to load creatures, couldn't count them");
+        return false;
+    }
+
+    u32 numCreatures = static_cast<u32>(countResult->GetField(0).GetU64());
+    if (numCreatures == 0)
+    {
+        DebugHandler::PrintSuccess("Added 0 Creatures.");
+        return true;
+    }
+
+    // Storage grows once up front instead of doubling its way up while the pages come in
+    registry.reserve(registry.size() + numCreatures);
+    registry.reserve<Transform, GameEntity, TransformIsDirty>(numCreatures);
+    creatures.reserve(numCreatures);
+
+    Progress progress;
+    EnqueuePage(workers, 0, 0, creatures, progress);
+
+    // Nothing else is running yet, so every completion we get here is one of ours
+    while (progress.numPages == 0 || progress.numPagesDone < progress.numPages)
+    {
+        DBCompletion completion;
+        if (workers.TryGetCompletion(completion))
+        {
+            completion(registry);
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    if (progress.didFail || creatures.size() != numCreatures)
+    {
+        DebugHandler::PrintError("Failed to load creatures, loaded %u of %u in %u pages", static_cast<u32>(creatures.size()), numCreatures, progress.numPages);
+        return false;
+    }
+
+    DebugHandler::PrintSuccess("Added %u Creatures in %u pages (%.2f ms).", static_cast<u32>(creatures.size()), progress.numPages, timer.GetLifeTime() * 1000.0f);
+    return true;
+}
+
+void CreatureLoader::Insert(entt::registry& registry, const SnapshotCreature* creatures, size_t numCreatures)
+{
+    std::vector<Transform> transforms(numCreatures);
+    std::vector<GameEntity> gameEntities;
+    gameEntities.reserve(numCreatures);
+
+    for (size_t i = 0; i < numCreatures; i++)
+    {
+        const SnapshotCreature& creature = creatures[i];
+
+        Transform& transform = transforms[i];
+        transform.position = creature.position;
+        transform.scale *= creature.scale;
+        transform.rotation.z = glm::degrees(creature.orientation);
+
+        gameEntities.emplace_back(GameEntity::Type::Creature, creature.displayID);
+    }
+
+    std::vector<entt::entity> entities(numCreatures);
+    registry.create(entities.begin(), entities.end());
+
+    registry.insert<Transform>(entities.begin(), entities.end(), transforms.begin(), transforms.end());
+    registry.insert<GameEntity>(entities.begin(), entities.end(), gameEntities.begin(), gameEntities.end());
+    registry.insert<TransformIsDirty>(entities.begin(), entities.end());
+}
+
+// Pages are read by id, each one after the last id of the page before it, so a page costs the same however sparse the ids are
+// The worker queues the next page as soon as it has read this one, the next query runs while this page is inserted on the engine thread
+void CreatureLoader::EnqueuePage(DBWorkerPool& workers, u32 pageIndex, u64 afterId, std::vector<SnapshotCreature>& creatures, Progress& progress)
+{
+    std::stringstream ss;
+    ss << "SELECT `id`, `displayId`, `scale`, `positionX`, `positionY`, `positionZ`, `orientation` FROM `creatures`";
+    if (pageIndex > 0)
+    {
+        ss << " WHERE `id` > " << afterId;
+    }
+    ss << " ORDER BY `id` LIMIT " << CREATURE_LOAD_CHUNK_SIZE << ";";
+
+    workers.Enqueue([&workers, sql = ss.str(), pageIndex, afterId, &creatures, &progress](DBConnection& connection) -> DBCompletion
+    {
+        std::shared_ptr<QueryResult> result = connection.Query(sql);
+        if (!result)
+        {
+            return [sql, pageIndex, &progress](entt::registry& /*registry*/)
+            {
+                DebugHandler::PrintError("Failed to load creatures: %s", sql.c_str());
+
+                progress.didFail = true;
+                progress.numPages = pageIndex + 1;
+                progress.numPagesDone++;
+            };
+        }
+
+        std::shared_ptr<CreatureChunk> chunk = std::make_shared<CreatureChunk>();
+        chunk->creatures.reserve(static_cast<size_t>(result->GetAffectedRows()));
+
+        u64 lastId = afterId;
+        while (result->GetNextRow())
+        {
+            lastId = result->GetField(0).GetU64();
+
+            SnapshotCreature& creature = chunk->creatures.emplace_back();
+            creature.displayID = result->GetField(1).GetU32();
+            creature.scale = result->GetField(2).GetF32();
+            creature.position = vec3(result->GetField(3).GetF32(), result->GetField(4).GetF32(), result->GetField(5).GetF32());
+            creature.orientation = result->GetField(6).GetF32();
+        }
+
+        // Only a full page can have more after it
+        bool hasNextPage = chunk->creatures.size() == CREATURE_LOAD_CHUNK_SIZE;
+        if (hasNextPage)
+        {
+            EnqueuePage(workers, pageIndex + 1, lastId, creatures, progress);
+        }
+
+        return [chunk, pageIndex, hasNextPage, &creatures, &progress](entt::registry& registry)
+        {
+            Insert(registry, chunk->creatures.data(), chunk->creatures.size());
+
+            // Kept for the snapshot
+            creatures.insert(creatures.end(), chunk->creatures.begin(), chunk->creatures.end());
+
+            if (!hasNextPage)
+            {
+                progress.numPages = pageIndex + 1;
+            }
+
+            progress.numPagesDone++;
+        };
+    });
+}
\ No newline at end of file
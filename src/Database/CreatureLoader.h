@@ -0,0 +1,29 @@
+#pragma once
+#include <NovusTypes.h>
+#include <entity/fwd.hpp>
+#include <vector>
+#include "WorldSnapshot.h"
+
+class DBConnection;
+class DBWorkerPool;
+
+// Creatures per page when loading them at startup, every page is queried and decoded on a DB worker
+// Also the number of creatures inserted at a time when loading from the snapshot
+#define CREATURE_LOAD_CHUNK_SIZE 16384
+
+// Loads the creatures table into the registry, the pages are read by the DB workers and inserted as they come in
+class CreatureLoader
+{
+public:
+    // Blocks until every page is in, connection only counts the rows up front
+    // Returns false unless every creature in the table was loaded, creatures holds what was (for the snapshot)
+    static bool Load(DBConnection& connection, DBWorkerPool& workers, entt::registry& registry, std::vector<SnapshotCreature>& creatures);
+
+    // Creates an entity per creature, all in one go
+    static void Insert(entt::registry& registry, const SnapshotCreature* creatures, size_t numCreatures);
+
+private:
+    struct Progress;
+
+    static void EnqueuePage(DBWorkerPool& workers, u32 pageIndex, u64 afterId, std::vector<SnapshotCreature>& creatures, Progress& progress);
+};
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "DBPreparedStatement.h"
+#include <Database/DBConnection.h>
+#include <cstdio>
+
+void DBParameter::AppendTo(DBConnection& connection, std::string& sql) const
+{
+    if (const std::string* value = std::get_if<std::string>(&_value))
+    {
+        sql += "'";
+        sql += connection.EscapeSQL(*value);
+        sql += "'";
+        return;
+    }
+
+    // Enough digits that a float or double reads back exactly
+    char literal[32];
+    if (const i64* value = std::get_if<i64>(&_value))
+    {
+        snprintf(literal, sizeof(literal), "%lld", static_cast<long long>(*value));
+    }
+    else if (const u64* value = std::get_if<u64>(&_value))
+    {
+        snprintf(literal, sizeof(literal), "%llu", static_cast<unsigned long long>(*value));
+    }
+    else if (const f32* value = std::get_if<f32>(&_value))
+    {
+        snprintf(literal, sizeof(literal), "%.9g", static_cast<f64>(*value));
+    }
+    else
+    {
+        snprintf(literal, sizeof(literal), "%.17g", std::get<f64>(_value));
+    }
+
+    sql += literal;
+}
+
+DBPreparedStatement::DBPreparedStatement(std::string sql) : _sql(std::move(sql))
+{
+    // A ? inside a quoted literal or identifier isn't a placeholder
+    char quote = 0;
+    for (char c : _sql)
+    {
+        if (quote != 0)
+        {
+            if (c == quote)
+            {
+                quote = 0;
+            }
+        }
+        else if (c == '\'' || c == '"' || c == '`')
+        {
+            quote = c;
+        }
+        else if (c == '?')
+        {
+            _numPlaceholders++;
+        }
+    }
+
+    _parameters.reserve(_numPlaceholders);
+}
+
+DBPreparedStatement& DBPreparedStatement::Bind(DBParameter parameter)
+{
+    _parameters.push_back(std::move(parameter));
+    return *this;
+}
+
+bool DBPreparedStatement::Build(DBConnection& connection, std::string& sql) const
+{
+    if (_parameters.size() != _numPlaceholders)
+        return false;
+
+    sql.clear();
+    sql.reserve(_sql.length() + _parameters.size() * 16);
+
+    size_t parameterIndex = 0;
+    char quote = 0;
+    for (char c : _sql)
+    {
+        if (quote != 0)
+        {
+            if (c == quote)
+            {
+                quote = 0;
+            }
+        }
+        else if (c == '\'' || c == '"' || c == '`')
+        {
+            quote = c;
+        }
+        else if (c == '?')
+        {
+            _parameters[parameterIndex++].AppendTo(connection, sql);
+            continue;
+        }
+
+        sql += c;
+    }
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+#include <NovusTypes.h>
+#include <string>
+#include <variant>
+#include <vector>
+
+class DBConnection;
+
+// A single value bound to a ? placeholder, strings are kept as they are and only escaped when the statement is built
+class DBParameter
+{
+public:
+    DBParameter(i32 value) : _value(std::in_place_type<i64>, value) { }
+    DBParameter(u32 value) : _value(std::in_place_type<u64>, value) { }
+    DBParameter(i64 value) : _value(std::in_place_type<i64>, value) { }
+    DBParameter(u64 value) : _value(std::in_place_type<u64>, value) { }
+    DBParameter(f32 value) : _value(std::in_place_type<f32>, value) { }
+    DBParameter(f64 value) : _value(std::in_place_type<f64>, value) { }
+    DBParameter(const char* value) : _value(std::in_place_type<std::string>, value) { }
+    DBParameter(std::string value) : _value(std::in_place_type<std::string>, std::move(value)) { }
+
+    // Appends the value as a SQL literal, strings are escaped through connection
+    void AppendTo(DBConnection& connection, std::string& sql) const;
+
+private:
+    std::variant<i64, u64, f32, f64, std::string> _value;
+};
+
+// SQL with ? placeholders and the values bound to them, so a value (say a username from a client) can't change what the statement does
+// This is not a server side prepared statement, DBConnection only takes SQL text. Build() interpolates the values into it, strings escaped through the connection
+// The worker pool calls Build() on the worker that runs the statement, with that worker's own connection
+class DBPreparedStatement
+{
+public:
+    DBPreparedStatement(std::string sql);
+
+    // Binds the next placeholder
+    DBPreparedStatement& Bind(DBParameter parameter);
+
+    // Builds the SQL text, returns false if the bound values don't match the placeholders
+    bool Build(DBConnection& connection, std::string& sql) const;
+
+    const std::string& GetSQL() const { return _sql; }
+    u32 GetNumPlaceholders() const { return _numPlaceholders; }
+    u32 GetNumBound() const { return static_cast<u32>(_parameters.size()); }
+
+private:
+    std::string _sql;
+    u32 _numPlaceholders = 0;
+
+    std::vector<DBParameter> _parameters;
+};
\ No newline at end of file
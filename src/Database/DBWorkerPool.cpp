@@ -0,0 +1,139 @@
+#include "DBWorkerPool.h"
+#include <Utils/DebugHandler.h>
+#include <tracy/Tracy.hpp>
+#include <chrono>
+
+void DBWorkerPool::Start(u32 numWorkers, const std::function<void(DBConnection&)>& connect)
+{
+    {
+        std::lock_guard<std::mutex> lock(_requestMutex);
+        _isRunning = true;
+    }
+
+    for (u32 i = 0; i < numWorkers; i++)
+    {
+        std::unique_ptr<DBConnection> connection = std::make_unique<DBConnection>();
+        connect(*connection);
+
+        _threads.emplace_back(&DBWorkerPool::Run, this, std::ref(*connection));
+        _connections.push_back(std::move(connection));
+    }
+}
+
+void DBWorkerPool::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_requestMutex);
+        _isRunning = false;
+    }
+
+    _requestCondition.notify_all();
+
+    for (std::thread& thread : _threads)
+    {
+        thread.join();
+    }
+
+    _threads.clear();
+    _connections.clear();
+}
+
+void DBWorkerPool::Enqueue(DBRequest request)
+{
+    _numPending++;
+
+    {
+        std::lock_guard<std::mutex> lock(_requestMutex);
+        _requests.push_back(std::move(request));
+    }
+
+    _requestCondition.notify_one();
+}
+
+void DBWorkerPool::Query(std::string sql, DBQueryCallback onComplete)
+{
+    Enqueue([sql = std::move(sql), onComplete = std::move(onComplete)](DBConnection& connection) -> DBCompletion
+    {
+        std::shared_ptr<QueryResult> result = connection.Query(sql);
+
+        return [result = std::move(result), onComplete](entt::registry& registry)
+        {
+            onComplete(registry, result);
+        };
+    });
+}
+
+void DBWorkerPool::Query(DBPreparedStatement statement, DBQueryCallback onComplete)
+{
+    Enqueue([statement = std::move(statement), onComplete = std::move(onComplete)](DBConnection& connection) -> DBCompletion
+    {
+        std::string sql;
+        if (!statement.Build(connection, sql))
+        {
+            // onComplete still runs, a null result is handled the same as a failed query
+            return [statement, onComplete](entt::registry& registry)
+            {
+                DebugHandler::PrintError("[Database]: %u values bound for %u placeholders in %s", statement.GetNumBound(), statement.GetNumPlaceholders(), statement.GetSQL().c_str());
+                onComplete(registry, nullptr);
+            };
+        }
+
+        std::shared_ptr<QueryResult> result = connection.Query(sql);
+
+        return [result = std::move(result), onComplete](entt::registry& registry)
+        {
+            onComplete(registry, result);
+        };
+    });
+}
+
+void DBWorkerPool::Execute(std::string sql)
+{
+    Enqueue([sql = std::move(sql)](DBConnection& connection) -> DBCompletion
+    {
+        if (connection.Execute(sql))
+            return nullptr;
+
+        return [sql](entt::registry& /*registry*/)
+        {
+            DebugHandler::PrintError("[Database]: Failed to execute %s", sql.c_str());
+        };
+    });
+}
+
+void DBWorkerPool::Run(DBConnection& connection)
+{
+    tracy::SetThreadName("DBWorker");
+
+    while (true)
+    {
+        DBRequest request;
+        {
+            std::unique_lock<std::mutex> lock(_requestMutex);
+            _requestCondition.wait(lock, [this]() { return !_requests.empty() || !_isRunning; });
+
+            // Only stops once everything queued is done
+            if (_requests.empty())
+                break;
+
+            request = std::move(_requests.front());
+            _requests.pop_front();
+        }
+
+        ZoneScopedNC("DBWorkerPool::Run", tracy::Color::Orange);
+
+        u32 latencyMS = _injectedLatencyMS.load(std::memory_order_relaxed);
+        if (latencyMS > 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(latencyMS));
+        }
+
+        DBCompletion completion = request(connection);
+        if (completion)
+        {
+            _completions.enqueue(std::move(completion));
+        }
+
+        _numPending--;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+#include <NovusTypes.h>
+#include <Utils/ConcurrentQueue.h>
+#include <Database/DBConnection.h>
+#include "DBPreparedStatement.h"
+#include <entity/fwd.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Worker threads, each with its own connection, so a slow query only ever holds up the ones queued behind it
+#ifndef DB_WORKER_COUNT
+#define DB_WORKER_COUNT 2
+#endif
+
+// Applied to the registry on the tick by DBCompletionSystem
+using DBCompletion = std::function<void(entt::registry&)>;
+
+// Runs on a worker, whatever it returns is applied on the tick (nothing if it returns an empty completion)
+using DBRequest = std::function<DBCompletion(DBConnection&)>;
+
+using DBQueryCallback = std::function<void(entt::registry&, std::shared_ptr<QueryResult>)>;
+
+// Keeps every database round trip off the tick, requests run in order per worker but not across workers
+class DBWorkerPool
+{
+public:
+    DBWorkerPool() : _completions(256) { }
+    ~DBWorkerPool() { Stop(); }
+
+    DBWorkerPool(const DBWorkerPool&) = delete;
+    DBWorkerPool& operator=(const DBWorkerPool&) = delete;
+
+    // connect is called once on every worker for its own connection
+    void Start(u32 numWorkers, const std::function<void(DBConnection&)>& connect);
+
+    // Finishes every request already queued before returning
+    void Stop();
+
+    void Enqueue(DBRequest request);
+
+    // onComplete runs on the tick with the result
+    void Query(std::string sql, DBQueryCallback onComplete);
+    void Query(DBPreparedStatement statement, DBQueryCallback onComplete);
+
+    // Fire and forget, a failed statement gets logged on the tick
+    void Execute(std::string sql);
+
+    bool TryGetCompletion(DBCompletion& completion) { return _completions.try_dequeue(completion); }
+
+    // Added to every request before it runs, stands in for a slow or distant database
+    void SetInjectedLatency(u32 latencyMS) { _injectedLatencyMS = latencyMS; }
+    u32 GetInjectedLatency() const { return _injectedLatencyMS; }
+
+    size_t GetNumPending() const { return _numPending; }
+
+private:
+    void Run(DBConnection& connection);
+
+private:
+    std::vector<std::thread> _threads;
+    std::vector<std::unique_ptr<DBConnection>> _connections;
+
+    std::mutex _requestMutex;
+    std::condition_variable _requestCondition;
+    std::deque<DBRequest> _requests;
+    bool _isRunning = false;
+
+    moodycamel::ConcurrentQueue<DBCompletion> _completions;
+
+    std::atomic<u32> _injectedLatencyMS = { 0 };
+    std::atomic<size_t> _numPending = { 0 };
+};
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include "DBWriteBehind.h"
+#include "DBWorkerPool.h"
+#include <Utils/DebugHandler.h>
+#include <tracy/Tracy.hpp>
+#include <cassert>
+
+DBWriteBehind::DBWriteBehind(DBWorkerPool& workers, std::string statement, u32 numColumns, u32 maxRows, f32 flushInterval) : _workers(workers), _statement(std::move(statement)), _numColumns(numColumns), _maxRows(maxRows), _flushInterval(flushInterval)
+{
+    _parameters.reserve(static_cast<size_t>(_maxRows) * _numColumns);
+}
+
+void DBWriteBehind::Add(std::initializer_list<DBParameter> row)
+{
+    assert(row.size() == _numColumns);
+
+    _parameters.insert(_parameters.end(), row.begin(), row.end());
+    _numRows++;
+
+    if (_numRows >= _maxRows)
+    {
+        Flush();
+    }
+}
+
+void DBWriteBehind::Update(f32 deltaTime)
+{
+    if (_numRows == 0)
+        return;
+
+    _timeSinceFirstRow += deltaTime;
+    if (_timeSinceFirstRow >= _flushInterval)
+    {
+        Flush();
+    }
+}
+
+void DBWriteBehind::Flush()
+{
+    if (_numRows == 0)
+        return;
+
+    ZoneScopedNC("DBWriteBehind::Flush", tracy::Color::Orange);
+
+    // The statement is only built on the worker, strings get escaped through its connection
+    _workers.Enqueue([this, statement = _statement, numColumns = _numColumns, numRows = _numRows, parameters = std::move(_parameters)](DBConnection& connection) -> DBCompletion
+    {
+        std::vector<std::string> failedRows;
+        u32 numUnwritten = 0;
+        if (ExecuteRows(connection, statement, numColumns, parameters, 0, numRows, failedRows, numUnwritten))
+            return nullptr;
+
+        return [this, statement, numRows, numUnwritten, failedRows = std::move(failedRows)](entt::registry& /*registry*/)
+        {
+            DebugHandler::PrintError("[Database/WriteBehind]: Batch of %u rows failed (%s), %u of them weren't written, %u rejected on their own", numRows, statement.c_str(), numUnwritten, static_cast<u32>(failedRows.size()));
+
+            for (const std::string& row : failedRows)
+            {
+                DebugHandler::PrintError("[Database/WriteBehind]: Dropped %s", row.c_str());
+            }
+
+            _numFailed += numUnwritten;
+        };
+    });
+
+    _numFlushed += _numRows;
+    _numStatements++;
+
+    // The moved from vector is left in an unspecified state, start over with a fresh one
+    _parameters = std::vector<DBParameter>();
+    _parameters.reserve(static_cast<size_t>(_maxRows) * _numColumns);
+
+    _numRows = 0;
+    _timeSinceFirstRow = 0.0f;
+}
+
+bool DBWriteBehind::ExecuteRows(DBConnection& connection, const std::string& statement, u32 numColumns, const std::vector<DBParameter>& parameters, u32 firstRow, u32 numRows, std::vector<std::string>& failedRows, u32& numUnwritten)
+{
+    std::string sql;
+    BuildRows(connection, statement, numColumns, parameters, firstRow, numRows, sql);
+
+    if (connection.Execute(sql))
+        return true;
+
+    // Only bad data (a duplicate key, a value out of range) is worth splitting for
+    if (!IsConnectionAlive(connection))
+    {
+        numUnwritten += numRows;
+        return false;
+    }
+
+    if (numRows == 1)
+    {
+        failedRows.push_back(std::move(sql));
+        numUnwritten++;
+        return false;
+    }
+
+    u32 numFirstHalf = numRows / 2;
+    ExecuteRows(connection, statement, numColumns, parameters, firstRow, numFirstHalf, failedRows, numUnwritten);
+    ExecuteRows(connection, statement, numColumns, parameters, firstRow + numFirstHalf, numRows - numFirstHalf, failedRows, numUnwritten);
+    return false;
+}
+
+bool DBWriteBehind::IsConnectionAlive(DBConnection& connection)
+{
+    return connection.Query("SELECT 1;") != nullptr;
+}
+
+void DBWriteBehind::BuildRows(DBConnection& connection, const std::string& statement, u32 numColumns, const std::vector<DBParameter>& parameters, u32 firstRow, u32 numRows, std::string& sql)
+{
+    sql = statement;
+    sql.reserve(statement.length() + static_cast<size_t>(numRows) * numColumns * 16);
+
+    for (u32 row = firstRow; row < firstRow + numRows; row++)
+    {
+        sql += row == firstRow ? "(" : ", (";
+
+        for (u32 column = 0; column < numColumns; column++)
+        {
+            if (column > 0)
+            {
+                sql += ", ";
+            }
+
+            parameters[static_cast<size_t>(row) * numColumns + column].AppendTo(connection, sql);
+        }
+
+        sql += ")";
+    }
+
+    sql += ";";
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+#include <NovusTypes.h>
+#include "DBPreparedStatement.h"
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+class DBConnection;
+class DBWorkerPool;
+
+// Rows per INSERT, keeps a full batch well below the server's max_allowed_packet
+#define DB_WRITE_BEHIND_MAX_ROWS 500
+
+// Seconds a row may wait for its batch to fill up before it gets flushed anyway
+#define DB_WRITE_BEHIND_FLUSH_INTERVAL 1.0f
+
+// Gathers rows for a single table on the tick and hands them to the worker pool as one multi-row INSERT
+// A batch goes out once it's full or DB_WRITE_BEHIND_FLUSH_INTERVAL after its first row, whichever comes first
+// Only ever touched by the tick, batches may run out of order across workers so it's only meant for rows that don't depend on each other
+// A batch the database rejects gets split in halves until only the bad rows are left, those are logged and dropped so one bad row doesn't take 499 good ones with it
+// Batches that failed because the connection did are dropped whole, splitting them would only fail every half the same way
+class DBWriteBehind
+{
+public:
+    // statement is everything up to the VALUES list, e.g "INSERT INTO `table` (`a`, `b`) VALUES ", and every row binds numColumns values
+    DBWriteBehind(DBWorkerPool& workers, std::string statement, u32 numColumns, u32 maxRows = DB_WRITE_BEHIND_MAX_ROWS, f32 flushInterval = DB_WRITE_BEHIND_FLUSH_INTERVAL);
+
+    DBWriteBehind(const DBWriteBehind&) = delete;
+    DBWriteBehind& operator=(const DBWriteBehind&) = delete;
+
+    // One value per column in the order of the statement's column list, strings are escaped on the worker
+    void Add(std::initializer_list<DBParameter> row);
+
+    // Flushes the batch if it has been waiting for too long
+    void Update(f32 deltaTime);
+
+    // Hands whatever is batched to the workers, called on shutdown before the workers are stopped so nothing is lost
+    void Flush();
+
+    u32 GetNumBatched() const { return _numRows; }
+    u64 GetNumFlushed() const { return _numFlushed; }
+    u64 GetNumStatements() const { return _numStatements; }
+    u64 GetNumFailed() const { return _numFailed; }
+
+private:
+    // Runs on a worker, splits rows [firstRow, firstRow + numRows) until every statement either went through or holds a single bad row
+    // Returns true if they all went through as one statement, numUnwritten counts the rows that didn't make it in the end
+    static bool ExecuteRows(DBConnection& connection, const std::string& statement, u32 numColumns, const std::vector<DBParameter>& parameters, u32 firstRow, u32 numRows, std::vector<std::string>& failedRows, u32& numUnwritten);
+
+    // DBConnection doesn't tell us why a statement failed, a lost connection fails this too while bad data can't
+    static bool IsConnectionAlive(DBConnection& connection);
+
+    static void BuildRows(DBConnection& connection, const std::string& statement, u32 numColumns, const std::vector<DBParameter>& parameters, u32 firstRow, u32 numRows, std::string& sql);
+
+private:
+    DBWorkerPool& _workers;
+
+    const std::string _statement;
+    const u32 _numColumns;
+    const u32 _maxRows;
+    const f32 _flushInterval;
+
+    std::vector<DBParameter> _parameters;
+    u32 _numRows = 0;
+    f32 _timeSinceFirstRow = 0.0f;
+
+    u64 _numFlushed = 0;
+    u64 _numStatements = 0;
+    u64 _numFailed = 0;
+};
\ No newline at end of file
@@ -0,0 +1,277 @@
+#include "WorldSnapshot.h"
+#include <Database/DBConnection.h>
+#include <Utils/DebugHandler.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool WorldSnapshot::Open(const std::string& path, const WorldSnapshotSource& source)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    _fileHandle = file;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(Header)))
+    {
+        Close();
+        return false;
+    }
+
+    _mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!_mappingHandle)
+    {
+        Close();
+        return false;
+    }
+
+    _data = static_cast<const u8*>(MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    _size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    i32 file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0)
+        return false;
+
+    struct stat fileStat;
+    if (fstat(file, &fileStat) != 0 || fileStat.st_size < static_cast<off_t>(sizeof(Header)))
+    {
+        close(file);
+        return false;
+    }
+
+    // The mapping holds its own reference to the file
+    void* data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+
+    if (data == MAP_FAILED)
+        return false;
+
+    _data = static_cast<const u8*>(data);
+    _size = static_cast<size_t>(fileStat.st_size);
+#endif
+
+    if (!_data)
+    {
+        Close();
+        return false;
+    }
+
+    Header header;
+    std::memcpy(&header, _data, sizeof(Header));
+
+    if (header.magic != MAGIC || header.version != WORLD_SNAPSHOT_VERSION)
+    {
+        DebugHandler::PrintWarning("[WorldSnapshot]: %s was written by another version, ignoring it", path.c_str());
+        Close();
+        return false;
+    }
+
+    if (header.source != source)
+    {
+        DebugHandler::PrintWarning("[WorldSnapshot]: %s is stale, the database changed since it was written", path.c_str());
+        Close();
+        return false;
+    }
+
+    const u8* payload = _data + sizeof(Header);
+    size_t payloadSize = _size - sizeof(Header);
+    size_t creaturesSize = static_cast<size_t>(header.numCreatures) * sizeof(SnapshotCreature);
+
+    if (header.payloadSize != payloadSize || creaturesSize > payloadSize || GetChecksum(payload, payloadSize) != header.payloadChecksum)
+    {
+        DebugHandler::PrintWarning("[WorldSnapshot]: %s is corrupt, ignoring it", path.c_str());
+        Close();
+        return false;
+    }
+
+    _creatures = reinterpret_cast<const SnapshotCreature*>(payload);
+    _numCreatures = header.numCreatures;
+
+    _teleportLocations = payload + creaturesSize;
+    _numTeleportLocations = header.numTeleportLocations;
+
+    return true;
+}
+
+void WorldSnapshot::Close()
+{
+#ifdef _WIN32
+    if (_data)
+    {
+        UnmapViewOfFile(_data);
+    }
+
+    if (_mappingHandle)
+    {
+        CloseHandle(_mappingHandle);
+        _mappingHandle = nullptr;
+    }
+
+    if (_fileHandle)
+    {
+        CloseHandle(_fileHandle);
+        _fileHandle = nullptr;
+    }
+#else
+    if (_data)
+    {
+        munmap(const_cast<u8*>(_data), _size);
+    }
+#endif
+
+    _data = nullptr;
+    _size = 0;
+
+    _creatures = nullptr;
+    _numCreatures = 0;
+
+    _teleportLocations = nullptr;
+    _numTeleportLocations = 0;
+}
+
+bool WorldSnapshot::ReadTeleportLocations(std::vector<TeleportLocation>& teleportLocations) const
+{
+    const u8* itr = _teleportLocations;
+    const u8* end = _data + _size;
+
+    teleportLocations.reserve(teleportLocations.size() + _numTeleportLocations);
+
+    for (u32 i = 0; i < _numTeleportLocations; i++)
+    {
+        constexpr size_t FixedSize = sizeof(u32) + sizeof(vec3) + sizeof(f32) + sizeof(u16);
+        if (static_cast<size_t>(end - itr) < FixedSize)
+            return false;
+
+        TeleportLocation& teleportLocation = teleportLocations.emplace_back();
+
+        std::memcpy(&teleportLocation.mapId, itr, sizeof(u32));
+        itr += sizeof(u32);
+        std::memcpy(&teleportLocation.position, itr, sizeof(vec3));
+        itr += sizeof(vec3);
+        std::memcpy(&teleportLocation.orientation, itr, sizeof(f32));
+        itr += sizeof(f32);
+
+        u16 nameLength;
+        std::memcpy(&nameLength, itr, sizeof(u16));
+        itr += sizeof(u16);
+
+        if (static_cast<size_t>(end - itr) < nameLength)
+            return false;
+
+        teleportLocation.name.assign(reinterpret_cast<const char*>(itr), nameLength);
+        itr += nameLength;
+    }
+
+    return true;
+}
+
+bool WorldSnapshot::QuerySource(DBConnection& connection, WorldSnapshotSource& source)
+{
+    std::shared_ptr<QueryResult> result = connection.Query("SELECT `version` FROM `world_version`;");
+    if (!result || !result->GetNextRow())
+        return false;
+
+    // A NULL version comes back as an empty string, that is no version rather than version 0
+    std::string value = result->GetField(0).GetString();
+    if (value.empty())
+        return false;
+
+    char* end = nullptr;
+    source.worldVersion = std::strtoull(value.c_str(), &end, 10);
+    return *end == '\0';
+}
+
+bool WorldSnapshot::Write(const std::string& path, const WorldSnapshotSource& source, const std::vector<SnapshotCreature>& creatures, const std::vector<TeleportLocation>& teleportLocations)
+{
+    std::vector<u8> payload(creatures.size() * sizeof(SnapshotCreature));
+    if (creatures.size() > 0)
+    {
+        std::memcpy(payload.data(), creatures.data(), payload.size());
+    }
+
+    for (const TeleportLocation& teleportLocation : teleportLocations)
+    {
+        u16 nameLength = static_cast<u16>(std::min<size_t>(teleportLocation.name.length(), UINT16_MAX));
+
+        size_t offset = payload.size();
+        payload.resize(offset + sizeof(u32) + sizeof(vec3) + sizeof(f32) + sizeof(u16) + nameLength);
+
+        u8* itr = payload.data() + offset;
+        std::memcpy(itr, &teleportLocation.mapId, sizeof(u32));
+        itr += sizeof(u32);
+        std::memcpy(itr, &teleportLocation.position, sizeof(vec3));
+        itr += sizeof(vec3);
+        std::memcpy(itr, &teleportLocation.orientation, sizeof(f32));
+        itr += sizeof(f32);
+        std::memcpy(itr, &nameLength, sizeof(u16));
+        itr += sizeof(u16);
+        std::memcpy(itr, teleportLocation.name.data(), nameLength);
+    }
+
+    Header header = {};
+    header.magic = MAGIC;
+    header.version = WORLD_SNAPSHOT_VERSION;
+    header.source = source;
+    header.numCreatures = static_cast<u32>(creatures.size());
+    header.numTeleportLocations = static_cast<u32>(teleportLocations.size());
+    header.payloadSize = payload.size();
+    header.payloadChecksum = GetChecksum(payload.data(), payload.size());
+
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        file.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+
+        if (!file)
+        {
+            file.close();
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+    }
+
+#ifdef _WIN32
+    // Windows won't rename over an existing file
+    std::remove(path.c_str());
+#endif
+    if (std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+u32 WorldSnapshot::GetChecksum(const u8* data, size_t size)
+{
+    // FNV-1a
+    u32 hash = 2166136261u;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
\ No newline at end of file
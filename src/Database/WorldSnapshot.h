@@ -0,0 +1,96 @@
+#pragma once
+#include <NovusTypes.h>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../Gameplay/Map/TeleportLocations.h"
+
+class DBConnection;
+
+#define WORLD_SNAPSHOT_PATH "WorldSnapshot.bin"
+
+// Bump whenever the layout of the file or any record in it changes
+#define WORLD_SNAPSHOT_VERSION 2
+
+// A creature row as it comes from the database, the snapshot stores these back to back
+struct SnapshotCreature
+{
+    vec3 position;
+    f32 scale;
+    f32 orientation;
+    u32 displayID;
+};
+static_assert(std::is_trivially_copyable_v<SnapshotCreature>, "SnapshotCreature is read straight out of the mapped file");
+
+// What the tables looked like when the snapshot was written, from the single row of `world_version`
+// Anything changing creatures or teleportlocations has to bump it, triggers on both tables do that for every writer:
+//   CREATE TABLE `world_version` (`version` BIGINT UNSIGNED NOT NULL);
+//   CREATE TRIGGER `creatures_changed_insert` AFTER INSERT ON `creatures` FOR EACH ROW UPDATE `world_version` SET `version` = `version` + 1;
+//   ...and the same AFTER UPDATE and AFTER DELETE, on both tables
+struct WorldSnapshotSource
+{
+    u64 worldVersion = 0;
+
+    bool operator==(const WorldSnapshotSource& other) const { return worldVersion == other.worldVersion; }
+    bool operator!=(const WorldSnapshotSource& other) const { return !(*this == other); }
+};
+
+// Binary copy of the static world (creatures and teleport locations) so a restart doesn't have to go through the database
+// The file is memory mapped, creatures are used in place and only teleport locations (variable length names) get decoded
+class WorldSnapshot
+{
+public:
+    WorldSnapshot() { }
+    ~WorldSnapshot() { Close(); }
+
+    WorldSnapshot(const WorldSnapshot&) = delete;
+    WorldSnapshot& operator=(const WorldSnapshot&) = delete;
+
+    // Fails if the file is missing, was written by another version, is corrupt or the tables changed since
+    bool Open(const std::string& path, const WorldSnapshotSource& source);
+    void Close();
+
+    const SnapshotCreature* GetCreatures() const { return _creatures; }
+    u32 GetNumCreatures() const { return _numCreatures; }
+
+    bool ReadTeleportLocations(std::vector<TeleportLocation>& teleportLocations) const;
+
+    // A single row read, returns false without the table or a version in it
+    static bool QuerySource(DBConnection& connection, WorldSnapshotSource& source);
+
+    // Written to a temporary file first, a crash halfway never leaves a snapshot behind that passes Open()
+    static bool Write(const std::string& path, const WorldSnapshotSource& source, const std::vector<SnapshotCreature>& creatures, const std::vector<TeleportLocation>& teleportLocations);
+
+private:
+    struct Header
+    {
+        u32 magic;
+        u32 version;
+        WorldSnapshotSource source;
+        u32 numCreatures;
+        u32 numTeleportLocations;
+        u64 payloadSize;
+        u32 payloadChecksum;
+        u32 padding;
+    };
+
+    static constexpr u32 MAGIC = 0x5357434E; // "NCWS"
+
+    static u32 GetChecksum(const u8* data, size_t size);
+
+private:
+    const u8* _data = nullptr;
+    size_t _size = 0;
+
+#ifdef _WIN32
+    void* _fileHandle = nullptr;
+    void* _mappingHandle = nullptr;
+#endif
+
+    const SnapshotCreature* _creatures = nullptr;
+    u32 _numCreatures = 0;
+
+    const u8* _teleportLocations = nullptr;
+    u32 _numTeleportLocations = 0;
+};
\ No newline at end of file
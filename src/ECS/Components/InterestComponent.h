@@ -0,0 +1,16 @@
+#pragma once
+#include <NovusTypes.h>
+#include <entity/fwd.hpp>
+#include <algorithm>
+#include <vector>
+
+struct InterestComponent
+{
+    // Kept sorted so the entering / leaving sets can be computed with a single linear merge
+    std::vector<entt::entity> visibleEntities;
+
+    bool IsVisible(entt::entity entity) const
+    {
+        return std::binary_search(visibleEntities.begin(), visibleEntities.end(), entity);
+    }
+};
\ No newline at end of file
@@ -1,9 +1,18 @@
 #pragma once
 #include <NovusTypes.h>
 #include <Utils/srp.h>
+#include <memory>
 
 struct Authentication
 {
     std::string username = "";
-    SRPVerifier srp;
+
+    // Shared with the auth worker running its math, components move around in memory but this doesn't
+    std::shared_ptr<SRPVerifier> srp = std::make_shared<SRPVerifier>();
+
+    // Set from the logon challenge until it is answered, through the account lookup on a DB worker and StartVerification on an auth worker
+    bool isChallengePending = false;
+
+    // Set while VerifySession is running on an auth worker
+    bool isHandshakePending = false;
 };
\ No newline at end of file
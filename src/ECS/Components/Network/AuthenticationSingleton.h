@@ -1,9 +1,18 @@
 #pragma once
 #include <NovusTypes.h>
 #include <Utils/srp.h>
+#include "../../../Network/AuthWorkerPool.h"
+#include "../../../Network/AccountCache.h"
 
 struct AuthenticationSingleton
 {
     std::string username = "";
     SRPUser srp;
+
+    // Verifies the logins of our own clients
+    AuthWorkerPool workers;
+    u64 numLogins = 0;
+    u64 numFailedLogins = 0;
+
+    AccountCache accountCache;
 };
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <Utils/ConcurrentQueue.h>
 #include <Networking/NetPacket.h>
 #include <Networking/NetClient.h>
+#include "../../../Network/PacketSegment.h"
+#include "../../../Network/NetworkChannel.h"
 
 enum class PacketPriority
 {
@@ -12,70 +14,94 @@ enum class PacketPriority
     IMMEDIATE
 };
 
+// Deadlines, a queued packet is sent at the latest this many seconds after it was queued (budget permitting)
 #define LOW_PRIORITY_TIME 1
 #define MEDIUM_PRIORITY_TIME 0.5f
 
+// Low priority packets still waiting on budget after this long are dropped
+#define LOW_PRIORITY_STALE_TIME 5.0f
+
+#define CONNECTION_SEND_BYTES_PER_SECOND (64 * 1024)
+#define CONNECTION_SEND_BURST_BYTES (32 * 1024)
+
+// Once the I/O thread holds this many unwritten bytes for a connection we stop handing it more, queued packets wait (and collapse) on the tick
+#define CONNECTION_SEND_BACKLOG_BYTES (64 * 1024)
+
+// Outbound budget per connection, a client that stays over it for CONNECTION_SLOW_CONSUMER_TIME seconds is disconnected
+// Going over CONNECTION_MAX_QUEUED_BYTES disconnects right away, so a stalled client can never hold more than that
+#define CONNECTION_QUEUED_BYTES_BUDGET (256 * 1024)
+#define CONNECTION_MAX_QUEUED_BYTES (1024 * 1024)
+#define CONNECTION_SLOW_CONSUMER_TIME 10.0f
+
 struct ConnectionComponent
 {
-    ConnectionComponent() : packetQueue(256)
-    {
-        lowPriorityBuffer = Bytebuffer::Borrow<8192>();
-        mediumPriorityBuffer = Bytebuffer::Borrow<8192>();
-        highPriorityBuffer = Bytebuffer::Borrow<8192>();
-    }
-
     std::shared_ptr<NetClient> netClient;
-    moodycamel::ConcurrentQueue<std::shared_ptr<NetPacket>> packetQueue;
 
-    void AddPacket(std::shared_ptr<Bytebuffer> buffer, PacketPriority priority = PacketPriority::MEDIUM)
+    // Shared with the network I/O thread owning the socket, holds the decoded packets waiting for the tick
+    std::shared_ptr<NetworkChannel> channel;
+
+    // The buffer must not be written to after this call, it is shared with every other connection it was added to
+    // ConnectionFlushSystem schedules every queue against its deadline at the end of the tick, unless an I/O thread can send urgent packets right away
+    // While queued, a packet is dropped if a newer one with the same supersedeKey is added (see PacketSendQueue::GetSupersedeKey)
+    void AddPacket(std::shared_ptr<Bytebuffer> buffer, PacketPriority priority = PacketPriority::MEDIUM, u64 supersedeKey = 0)
     {
-        assert(buffer->writtenData <= 8192);
+        assert(buffer->writtenData <= PACKET_WRITE_BUFFER_SIZE);
 
-        std::shared_ptr<Bytebuffer> bufferToUse = nullptr;
-        if (priority == PacketPriority::LOW)
+        PacketSegment segment(std::move(buffer));
+        if (priority >= PacketPriority::HIGH && CanSendUrgent())
         {
-            bufferToUse = lowPriorityBuffer;
-        }
-        else if (priority == PacketPriority::MEDIUM)
-        {
-            bufferToUse = mediumPriorityBuffer;
-        }
-        else if (priority == PacketPriority::HIGH)
-        {
-            bufferToUse = highPriorityBuffer;
+            sendBudget -= segment.GetSize();
+            channel->Send(segment);
+            return;
         }
-        else if (priority == PacketPriority::IMMEDIATE)
+
+        GetSendQueue(priority).Push(segment, supersedeKey);
+    }
+
+    // Urgent packets skip the queues only if nothing urgent is already waiting in them, they must not overtake it
+    bool CanSendUrgent() const
+    {
+        return channel->HasIOThread() && !IsBackedUp() && sendQueues[static_cast<u8>(PacketPriority::HIGH)].IsEmpty() && sendQueues[static_cast<u8>(PacketPriority::IMMEDIATE)].IsEmpty();
+    }
+
+    bool IsBackedUp() const { return channel->pendingSendBytes.load(std::memory_order_relaxed) >= CONNECTION_SEND_BACKLOG_BYTES; }
+
+    // Everything we hold for this connection that hasn't reached the socket yet
+    size_t GetQueuedBytes() const
+    {
+        size_t queuedBytes = channel->pendingSendBytes.load(std::memory_order_relaxed);
+        for (const PacketSendQueue& sendQueue : sendQueues)
         {
-            netClient->Send(buffer);
-            return;
+            queuedBytes += sendQueue.queuedBytes;
         }
 
-        // We send priority buffer's content before we add this due to size constraints
-        if (bufferToUse->GetSpace() < buffer->writtenData)
+        return queuedBytes;
+    }
+
+    // Time the oldest queued packet was stamped, or -1 if nothing is queued on the tick
+    f32 GetOldestQueuedTime() const
+    {
+        f32 oldestTime = -1.0f;
+        for (const PacketSendQueue& sendQueue : sendQueues)
         {
-            size_t spaceLeft = buffer->writtenData - bufferToUse->GetSpace();
-            if (spaceLeft > 0)
-            {
-                memset(bufferToUse->GetWritePointer(), 0, spaceLeft);
-            }
-
-            netClient->Send(bufferToUse);
-            bufferToUse->Reset();
-
-            if (bufferToUse == lowPriorityBuffer)
-                lowPriorityTimer = 0;
-            else if (bufferToUse == mediumPriorityBuffer)
-                mediumPriorityTimer = 0;
+            f32 queuedTime = sendQueue.GetOldestQueuedTime();
+            if (queuedTime >= 0.0f && (oldestTime < 0.0f || queuedTime < oldestTime))
+                oldestTime = queuedTime;
         }
 
-        memcpy(bufferToUse->GetWritePointer(), buffer->GetDataPointer(), buffer->writtenData);
-        bufferToUse->writtenData += buffer->writtenData;
+        return oldestTime;
     }
 
-    // The reason we are not using the Timer class is due to performance reasons (Timer creates a timepoint every call to GetLifetime())
-    f32 lowPriorityTimer = 0;
-    f32 mediumPriorityTimer = 0;
-    std::shared_ptr<Bytebuffer> lowPriorityBuffer;
-    std::shared_ptr<Bytebuffer> mediumPriorityBuffer;
-    std::shared_ptr<Bytebuffer> highPriorityBuffer;
+    PacketSendQueue& GetSendQueue(PacketPriority priority)
+    {
+        return sendQueues[static_cast<u8>(priority)];
+    }
+
+    PacketSendQueue sendQueues[static_cast<u8>(PacketPriority::IMMEDIATE) + 1];
+
+    // Bytes we may still send, refilled at CONNECTION_SEND_BYTES_PER_SECOND up to CONNECTION_SEND_BURST_BYTES
+    f32 sendBudget = CONNECTION_SEND_BURST_BYTES;
+
+    // How long GetQueuedBytes() has been over CONNECTION_QUEUED_BYTES_BUDGET without a break
+    f32 overBudgetTime = 0.0f;
 };
\ No newline at end of file
@@ -3,12 +3,26 @@
 #include <Utils/ConcurrentQueue.h>
 #include <Networking/NetClient.h>
 #include <Networking/NetServer.h>
+#include <entity/fwd.hpp>
+#include <vector>
+
+// Connections admitted per tick, everyone reconnecting after a restart waits in newConnectionQueue instead of stalling a single tick
+// Sockets aren't read until they're admitted, whatever the clients send in the meantime waits in the kernel
+#ifndef CONNECTION_ADMISSIONS_PER_TICK
+#define CONNECTION_ADMISSIONS_PER_TICK 256
+#endif
 
 struct ConnectionDeferredSingleton
 {
-    ConnectionDeferredSingleton() : newConnectionQueue(64), droppedConnectionQueue(32) { }
+    ConnectionDeferredSingleton() : newConnectionQueue(1024), droppedConnectionQueue(1024) { }
 
     std::shared_ptr<NetServer> netServer;
     moodycamel::ConcurrentQueue<std::shared_ptr<NetClient>> newConnectionQueue;
     moodycamel::ConcurrentQueue<entt::entity> droppedConnectionQueue;
+
+    u32 admissionsPerTick = CONNECTION_ADMISSIONS_PER_TICK;
+
+    // Reused every tick by ConnectionDeferredSystem
+    std::vector<std::shared_ptr<NetClient>> admittedClients;
+    std::vector<entt::entity> admittedEntities;
 };
\ No newline at end of file
@@ -3,12 +3,13 @@
 #include <Utils/ConcurrentQueue.h>
 #include <Networking/NetPacket.h>
 #include <Networking/NetClient.h>
+#include "../../../Network/NetworkChannel.h"
 
 struct ConnectionSingleton
 {
-    ConnectionSingleton() : packetQueue(256) { }
-
     std::shared_ptr<NetClient> netClient;
     bool didHandleDisconnect = false;
-    moodycamel::ConcurrentQueue<std::shared_ptr<NetPacket>> packetQueue;
+
+    // Always read by the tick, never handed to an I/O thread
+    std::shared_ptr<NetworkChannel> channel;
 };
\ No newline at end of file
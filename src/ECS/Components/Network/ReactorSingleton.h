@@ -0,0 +1,18 @@
+#pragma once
+#include <NovusTypes.h>
+#include <entity/fwd.hpp>
+#include <vector>
+#include "../../../Network/SocketReactor.h"
+#include "../../../Network/NetworkIOThreadPool.h"
+
+struct ReactorSingleton
+{
+    SocketReactor reactor;
+    std::vector<u64> readyTokens;
+
+    // Owns the client sockets when running, the reactor above is then only used for the internal link
+    std::shared_ptr<NetworkIOThreadPool> ioThreadPool;
+
+    static u64 GetToken(entt::entity entity) { return static_cast<u64>(entt::to_integral(entity)); }
+    static entt::entity GetEntity(u64 token) { return static_cast<entt::entity>(token); }
+};
\ No newline at end of file
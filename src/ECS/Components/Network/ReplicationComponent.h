@@ -0,0 +1,40 @@
+#pragma once
+#include <NovusTypes.h>
+#include <entity/fwd.hpp>
+#include <robin_hood.h>
+#include "../../../Network/MovementReplication.h"
+
+struct ReplicationBaseline
+{
+    QuantizedTransform transform;
+    f32 keyframeTime = 0.0f;
+};
+
+// What this connection's client last received for every entity it can see, TCP guarantees it arrives so sent == acknowledged
+// Movement updates are deltas against it, so it may only move forward once the update is actually queued for the client
+struct ReplicationComponent
+{
+    robin_hood::unordered_map<entt::entity, ReplicationBaseline> baselines;
+
+    // The client got the full state (SMSG_CREATE_ENTITY or a keyframe)
+    void SetBaseline(entt::entity entity, const QuantizedTransform& transform, f32 time)
+    {
+        ReplicationBaseline& baseline = baselines[entity];
+        baseline.transform = transform;
+        baseline.keyframeTime = time;
+    }
+
+    void RemoveBaseline(entt::entity entity)
+    {
+        baselines.erase(entity);
+    }
+
+    ReplicationBaseline* GetBaseline(entt::entity entity)
+    {
+        auto itr = baselines.find(entity);
+        if (itr == baselines.end())
+            return nullptr;
+
+        return &itr->second;
+    }
+};
\ No newline at end of file
@@ -1,11 +1,18 @@
 #pragma once
 #include <Database/DBConnection.h>
 #include <Database/DBTypes.h>
+#include "../../../Database/DBWorkerPool.h"
+#include "../../../Database/DBWriteBehind.h"
 
 struct DBSingleton
 {
 public:
-    DBSingleton() : auth() { }
+    DBSingleton() : auth(), teleportLocations(workers, "INSERT INTO `teleportlocations` (`name`, `mapId`, `positionX`, `positionY`, `positionZ`, `orientation`) VALUES ", 6) { }
 
+    // Blocking, only for loading data at startup, anything the tick needs goes through workers
     DBConnection auth;
+    DBWorkerPool workers;
+
+    // Write behind batches, flushed by DBCompletionSystem
+    DBWriteBehind teleportLocations;
 };
\ No newline at end of file
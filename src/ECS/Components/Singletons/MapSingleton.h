@@ -23,23 +23,20 @@
 */
 #pragma once
 #include <NovusTypes.h>
-#include <Containers/KDTree.h>
 #include <vector>
 #include "../../../Gameplay/Map/Map.h"
-
-typedef KDPoint<f32, entt::entity, 2> Point2D;
-typedef KDTree<f32, entt::entity, 2> Tree2D;
+#include "../../../Gameplay/Map/SpatialGrid.h"
 
 struct MapSingleton
 {
 	MapSingleton() { }
 
 	Terrain::Map& GetCurrentMap() { return _currentMap; }
-	Tree2D& GetPlayerTree() { return _playerTree; };
-	Tree2D& GetEntityTree() { return _entityTree; };
+	SpatialGrid& GetPlayerGrid() { return _playerGrid; };
+	SpatialGrid& GetEntityGrid() { return _entityGrid; };
 
 private:
 	Terrain::Map _currentMap;
-	Tree2D _playerTree;
-	Tree2D _entityTree;
+	SpatialGrid _playerGrid;
+	SpatialGrid _entityGrid;
 };
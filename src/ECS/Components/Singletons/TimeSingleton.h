@@ -6,4 +6,7 @@ struct TimeSingleton
     f32 deltaTime;
     f32 lifeTimeInS;
     f32 lifeTimeInMS;
+
+    // Longest Update() since the "auth" command last printed it
+    f32 longestUpdateInS = 0.0f;
 };
\ No newline at end of file
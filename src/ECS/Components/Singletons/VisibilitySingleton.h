@@ -0,0 +1,55 @@
+#pragma once
+#include <NovusTypes.h>
+#include <entity/fwd.hpp>
+#include <robin_hood.h>
+#include <vector>
+#include "../../../Gameplay/Map/SpatialGrid.h"
+
+struct InterestComponent;
+
+struct VisibilityRecord
+{
+    enum class Type : u8
+    {
+        ENTER,
+        LEAVE,
+        UPDATE
+    };
+
+    Type type;
+    entt::entity observer;
+    entt::entity subject;
+};
+
+struct VisibilityCandidate
+{
+    entt::entity entity;
+    f32 distanceSquared;
+};
+
+struct VisibilityPlayer
+{
+    entt::entity entity;
+    vec2 position;
+    bool isDirty;
+    InterestComponent* interest;
+};
+
+// Every worker only ever touches its own staging, the records are merged into the connections serially afterwards
+struct VisibilityWorkerStaging
+{
+    std::vector<VisibilityRecord> records;
+    std::vector<vec2> queryPositions;
+    RadiusQueryResults queryResults;
+    std::vector<VisibilityCandidate> candidates;
+    std::vector<entt::entity> visibleEntities;
+};
+
+struct VisibilitySingleton
+{
+    // Snapshot of all players taken before the parallel phases, workers never touch the registry directly
+    std::vector<VisibilityPlayer> players;
+    robin_hood::unordered_map<entt::entity, u32> entityToPlayerIndex;
+
+    std::vector<VisibilityWorkerStaging> workerStaging;
+};
\ No newline at end of file
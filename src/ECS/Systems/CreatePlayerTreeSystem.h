@@ -1,8 +0,0 @@
-#pragma once
-#include <entity/fwd.hpp>
-
-class CreatePlayerTreeSystem
-{
-public:
-    static void Update(entt::registry& registry);
-};
\ No newline at end of file
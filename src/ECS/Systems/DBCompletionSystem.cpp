@@ -0,0 +1,22 @@
+#include "DBCompletionSystem.h"
+#include <entt.hpp>
+#include <tracy/Tracy.hpp>
+
+#include "../Components/Singletons/DBSingleton.h"
+#include "../Components/Singletons/TimeSingleton.h"
+
+void DBCompletionSystem::Update(entt::registry& registry)
+{
+    ZoneScopedNC("DBCompletionSystem::Update", tracy::Color::Blue);
+
+    DBSingleton& dbSingleton = registry.ctx<DBSingleton>();
+
+    DBCompletion completion;
+    while (dbSingleton.workers.TryGetCompletion(completion))
+    {
+        completion(registry);
+    }
+
+    TimeSingleton& timeSingleton = registry.ctx<TimeSingleton>();
+    dbSingleton.teleportLocations.Update(timeSingleton.deltaTime);
+}
\ No newline at end of file
@@ -0,0 +1,9 @@
+#pragma once
+#include <entity/fwd.hpp>
+
+// Applies the results of every database request that finished since the last tick and flushes write behind batches that waited long enough
+class DBCompletionSystem
+{
+public:
+    static void Update(entt::registry& registry);
+};
\ No newline at end of file
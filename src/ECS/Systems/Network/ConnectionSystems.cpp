@@ -2,7 +2,7 @@
 #include <entt.hpp>
 #include <Networking/NetClient.h>
 #include <Networking/NetServer.h>
-#include <Networking/NetPacketHandler.h>
+#include <Networking/NetPacket.h>
 #include <Utils/DebugHandler.h>
 #include "../../../Utils/ServiceLocator.h"
 #include "../../Components/Singletons/TimeSingleton.h"
@@ -10,115 +10,173 @@
 #include "../../Components/Network/AuthenticationSingleton.h"
 #include "../../Components/Network/ConnectionComponent.h"
 #include "../../Components/Network/ConnectionDeferredSingleton.h"
+#include "../../Components/Network/ReactorSingleton.h"
 #include "../../Components/Network/Authentication.h"
 #include "../../Components/Singletons/MapSingleton.h"
 #include "../../../Gameplay/Map/Map.h"
+#include "../../../Network/Handlers/Self/GeneralHandlers.h"
+#include "../../../Network/Handlers/Client/GeneralHandlers.h"
 #include <Gameplay/ECS/Components/Transform.h>
 
 #include <tracy/Tracy.hpp>
+#include <algorithm>
 
 void ConnectionUpdateSystem::Update(entt::registry& registry)
 {
     ZoneScopedNC("ConnectionUpdateSystem::Update", tracy::Color::Blue);
 
-    ConnectionSingleton& connectionSingleton = registry.ctx<ConnectionSingleton>();
-    if (connectionSingleton.netClient)
+    ReactorSingleton& reactorSingleton = registry.ctx<ReactorSingleton>();
+    std::vector<u64>& readyTokens = reactorSingleton.readyTokens;
+
+    if (reactorSingleton.reactor.IsAvailable())
     {
-        if (connectionSingleton.netClient->Read())
+        // Only sockets with pending data (or a pending hangup) are visited, idle connections cost nothing
+        // With the I/O threads running only the internal link is registered here
+        reactorSingleton.reactor.Poll(readyTokens);
+
+        for (u64 token : readyTokens)
         {
-            Self_HandleRead(connectionSingleton.netClient);
+            if (token == SocketReactor::SELF_TOKEN)
+            {
+                UpdateSelf(registry);
+                continue;
+            }
+
+            entt::entity entity = ReactorSingleton::GetEntity(token);
+            if (!registry.valid(entity))
+                continue;
+
+            ConnectionComponent* connection = registry.try_get<ConnectionComponent>(entity);
+            if (!connection)
+                continue;
+
+            UpdateClient(*connection);
         }
+    }
+    else
+    {
+        // Without readiness information every socket has to be read
+        UpdateSelf(registry);
 
-        if (!connectionSingleton.netClient->IsConnected())
+        if (!reactorSingleton.ioThreadPool)
         {
-            if (!connectionSingleton.didHandleDisconnect)
+            auto view = registry.view<ConnectionComponent>();
+            view.each([](const auto, ConnectionComponent& connection)
             {
-                connectionSingleton.didHandleDisconnect = true;
-
-                Self_HandleDisconnect(connectionSingleton.netClient);
-            }
+                UpdateClient(connection);
+            });
         }
-        else
+    }
+
+    if (reactorSingleton.ioThreadPool)
+    {
+        // The I/O threads have already read and framed everything, only connections with packets waiting (or that were dropped) are visited
+        reactorSingleton.ioThreadPool->GetReadyTokens(readyTokens);
+
+        for (u64 token : readyTokens)
         {
-            NetPacketHandler* selfNetPacketHandler = ServiceLocator::GetSelfNetPacketHandler();
+            entt::entity entity = ReactorSingleton::GetEntity(token);
+            if (!registry.valid(entity))
+                continue;
 
-            std::shared_ptr<NetPacket> packet = nullptr;
-            while (connectionSingleton.packetQueue.try_dequeue(packet))
-            {
-#ifdef NC_Debug
-                DebugHandler::PrintSuccess("[Network/ClientSocket]: CMD: %u, Size: %u", packet->header.opcode, packet->header.size);
-#endif // NC_Debug
+            ConnectionComponent* connection = registry.try_get<ConnectionComponent>(entity);
+            if (!connection)
+                continue;
 
-                if (!selfNetPacketHandler->CallHandler(connectionSingleton.netClient, packet))
-                {
-                    connectionSingleton.netClient->Close();
-                    return;
-                }
+            // Cleared before consuming, packets framed from here on queue the connection again
+            connection->channel->isPendingTick = false;
+            HandleClientPackets(*connection);
+
+            // Everything we just handled went back to the receive ring, so its I/O thread can start reading the socket again
+            if (connection->channel->isReadPaused)
+            {
+                connection->channel->ioThread->ScheduleResume();
             }
         }
     }
+}
 
-    TimeSingleton& timeSingleton = registry.ctx<TimeSingleton>();
-    f32 deltaTime = timeSingleton.deltaTime;
-
-    NetPacketHandler* clientNetPacketHandler = ServiceLocator::GetClientNetPacketHandler();
+void ConnectionUpdateSystem::UpdateSelf(entt::registry& registry)
+{
+    ConnectionSingleton& connectionSingleton = registry.ctx<ConnectionSingleton>();
+    if (!connectionSingleton.netClient)
+        return;
 
-    auto view = registry.view<ConnectionComponent>();
-    view.each([&registry, &clientNetPacketHandler, &deltaTime](const auto, ConnectionComponent& connection)
+    // Same as UpdateClient, a full receive ring is read again once the packets it holds were handled
+    u32 numPackets = 0;
+    do
     {
-        if (connection.netClient->Read())
-        {
-            Client_HandleRead(connection.netClient);
-        }
+        // A closed handle might already belong to someone else, it's never read again
+        numPackets = connectionSingleton.channel->IsConnected() ? connectionSingleton.channel->Receive() : 0;
 
-        if (!connection.netClient->IsConnected())
+        if (!connectionSingleton.channel->IsConnected())
         {
-            Client_HandleDisconnect(connection.netClient);
+            if (!connectionSingleton.didHandleDisconnect)
+            {
+                connectionSingleton.didHandleDisconnect = true;
+
+                Self_HandleDisconnect(connectionSingleton.netClient);
+            }
+
             return;
         }
 
         std::shared_ptr<NetPacket> packet = nullptr;
-        while (connection.packetQueue.try_dequeue(packet))
+        while (connectionSingleton.channel->packetQueue.try_dequeue(packet))
         {
 #ifdef NC_Debug
-           DebugHandler::PrintSuccess("[Network/ServerSocket]: CMD: %u, Size: %u", packet->header.opcode, packet->header.size);
+            DebugHandler::PrintSuccess("[Network/ClientSocket]: CMD: %u, Size: %u", packet->header.opcode, packet->header.size);
 #endif // NC_Debug
 
-            if (!clientNetPacketHandler->CallHandler(connection.netClient, packet))
+            if (!InternalSocket::Dispatch(*connectionSingleton.netClient, *packet))
             {
-                connection.netClient->Close();
+                connectionSingleton.channel->Close();
                 return;
             }
+        }
+    } while (numPackets > 0 && connectionSingleton.channel->isReadPaused);
+}
 
-            if (connection.lowPriorityBuffer->writtenData)
-            {
-                connection.lowPriorityTimer += deltaTime;
-                if (connection.lowPriorityTimer >= LOW_PRIORITY_TIME)
-                {
-                    connection.lowPriorityTimer = 0;
-                    connection.netClient->Send(connection.lowPriorityBuffer);
-                    connection.lowPriorityBuffer->Reset();
-                }
-            }
+void ConnectionUpdateSystem::UpdateClient(ConnectionComponent& connection)
+{
+    // A full receive ring stops reading, handling its packets gives the space back so we pick up right where it stopped
+    // The socket might not be reported ready again if the peer already sent everything
+    u32 numPackets = 0;
+    do
+    {
+        // Closed by the tick, the socket is only still reported so the connection gets dropped
+        numPackets = connection.channel->IsConnected() ? connection.channel->Receive() : 0;
+        HandleClientPackets(connection);
+    } while (numPackets > 0 && connection.channel->isReadPaused && connection.channel->IsConnected());
+}
 
-            if (connection.mediumPriorityBuffer->writtenData)
-            {
-                connection.mediumPriorityTimer += deltaTime;
-                if (connection.mediumPriorityTimer >= MEDIUM_PRIORITY_TIME)
-                {
-                    connection.mediumPriorityTimer = 0;
-                    connection.netClient->Send(connection.mediumPriorityBuffer);
-                    connection.mediumPriorityBuffer->Reset();
-                }
-            }
+void ConnectionUpdateSystem::HandleClientPackets(ConnectionComponent& connection)
+{
+    if (!connection.channel->IsConnected())
+    {
+        Client_HandleDisconnect(connection.netClient);
+        return;
+    }
 
-            if (connection.highPriorityBuffer->writtenData)
-            {
-                connection.netClient->Send(connection.highPriorityBuffer);
-                connection.highPriorityBuffer->Reset();
-            }
+    std::shared_ptr<NetPacket> packet = nullptr;
+    while (connection.channel->packetQueue.try_dequeue(packet))
+    {
+#ifdef NC_Debug
+        DebugHandler::PrintSuccess("[Network/ServerSocket]: CMD: %u, Size: %u", packet->header.opcode, packet->header.size);
+#endif // NC_Debug
+
+        if (!Client::Dispatch(*connection.netClient, *packet))
+        {
+            connection.channel->Close();
+            break;
         }
-    });
+    }
+
+    // A closed socket might never be reported as ready again, so it has to be dropped while we still have it
+    if (!connection.channel->IsConnected())
+    {
+        Client_HandleDisconnect(connection.netClient);
+    }
 }
 
 bool ConnectionUpdateSystem::Server_HandleConnect(std::shared_ptr<NetClient> netClient)
@@ -141,84 +199,6 @@ bool ConnectionUpdateSystem::Server_HandleConnect(std::shared_ptr<NetClient> net
     return true;
 }
 
-void ConnectionUpdateSystem::Client_HandleRead(std::shared_ptr<NetClient> netClient)
-{
-    std::shared_ptr<Bytebuffer> buffer = netClient->GetReadBuffer();
-    entt::registry* registry = ServiceLocator::GetRegistry();
-
-    const entt::entity& entity = netClient->GetEntity();
-    ConnectionComponent& connectionComponent = registry->get<ConnectionComponent>(entity);
-
-    while (size_t activeSize = buffer->GetActiveSize())
-    {
-        // We have received a partial header and need to read more
-        if (activeSize < sizeof(PacketHeader))
-        {
-            buffer->Normalize();
-            break;
-        }
-
-        PacketHeader* header = reinterpret_cast<PacketHeader*>(buffer->GetReadPointer());
-
-        if (header->opcode == Opcode::INVALID || header->opcode > Opcode::MAX_COUNT)
-        {
-#ifdef NC_Debug
-            DebugHandler::PrintError("Received Invalid Opcode (%u) from network stream", static_cast<u16>(header->opcode));
-#endif // NC_Debug
-            break;
-        }
-
-        if (header->size > 8192)
-        {
-#ifdef NC_Debug
-            DebugHandler::PrintError("Received Invalid Opcode Size (%u) from network stream", header->size);
-#endif // NC_Debug
-            break;
-        }
-        size_t sizeWithoutHeader = activeSize - sizeof(PacketHeader);
-
-        // We have received a valid header, but we have yet to receive the entire payload
-        if (sizeWithoutHeader < header->size)
-        {
-            buffer->Normalize();
-            break;
-        }
-
-        // Skip Header
-        buffer->SkipRead(sizeof(PacketHeader));
-
-        std::shared_ptr<NetPacket> packet = NetPacket::Borrow();
-        {
-            // Header
-            {
-                packet->header = *header;
-            }
-
-            // Payload
-            {
-                if (packet->header.size)
-                {
-                    packet->payload = Bytebuffer::Borrow<8192/*NETWORK_BUFFER_SIZE*/ >();
-                    packet->payload->size = packet->header.size;
-                    packet->payload->writtenData = packet->header.size;
-                    std::memcpy(packet->payload->GetDataPointer(), buffer->GetReadPointer(), packet->header.size);
-
-                    // Skip Payload
-                    buffer->SkipRead(header->size);
-                }
-            }
-
-            connectionComponent.packetQueue.enqueue(packet);
-        }
-    }
-
-    // Only reset if we read everything that was written
-    if (buffer->GetActiveSize() == 0)
-    {
-        buffer->Reset();
-    }
-}
-
 void ConnectionUpdateSystem::Client_HandleDisconnect(std::shared_ptr<NetClient> netClient)
 {
 #ifdef NC_Debug
@@ -280,119 +260,218 @@ void ConnectionUpdateSystem::Self_HandleConnect(std::shared_ptr<NetClient> netCl
     }
 }
 
-void ConnectionUpdateSystem::Self_HandleRead(std::shared_ptr<NetClient> netClient)
+void ConnectionUpdateSystem::Self_HandleDisconnect(std::shared_ptr<NetClient> netClient)
 {
+#ifdef NC_Debug
+    const NetSocket::ConnectionInfo& connectionInfo = netClient->GetSocket()->GetConnectionInfo();
+    DebugHandler::PrintWarning("[Network/Socket]: Disconnected from (%s, %u)", connectionInfo.ipAddrStr.c_str(), connectionInfo.port);
+#endif // NC_Debug
+
+    // Password changes made while the link is down would never reach us
     entt::registry* registry = ServiceLocator::GetRegistry();
-    ConnectionSingleton& connectionSingleton = registry->ctx<ConnectionSingleton>();
+    registry->ctx<AuthenticationSingleton>().accountCache.SetEnabled(false);
+}
 
-    std::shared_ptr<Bytebuffer> buffer = netClient->GetReadBuffer();
+void ConnectionDeferredSystem::Update(entt::registry& registry)
+{
+    ConnectionDeferredSingleton& connectionDeferredSingleton = registry.ctx<ConnectionDeferredSingleton>();
+    ReactorSingleton& reactorSingleton = registry.ctx<ReactorSingleton>();
 
-    while (size_t activeSize = buffer->GetActiveSize())
+    if (connectionDeferredSingleton.newConnectionQueue.size_approx() > 0)
     {
-        // We have received a partial header and need to read more
-        if (activeSize < sizeof(PacketHeader))
-        {
-            buffer->Normalize();
-            break;
-        }
+        std::vector<std::shared_ptr<NetClient>>& admittedClients = connectionDeferredSingleton.admittedClients;
+        std::vector<entt::entity>& admittedEntities = connectionDeferredSingleton.admittedEntities;
 
-        PacketHeader* header = reinterpret_cast<PacketHeader*>(buffer->GetReadPointer());
+        admittedClients.resize(connectionDeferredSingleton.admissionsPerTick);
+        size_t numAdmitted = connectionDeferredSingleton.newConnectionQueue.try_dequeue_bulk(admittedClients.begin(), admittedClients.size());
 
-        if (header->opcode == Opcode::INVALID || header->opcode > Opcode::MAX_COUNT)
-        {
-#ifdef NC_Debug
-            DebugHandler::PrintError("Received Invalid Opcode (%u) from network stream", static_cast<u16>(header->opcode));
-#endif // NC_Debug
-            break;
-        }
+        admittedEntities.resize(numAdmitted);
+        registry.create(admittedEntities.begin(), admittedEntities.end());
 
-        if (header->size > 8192)
+        for (size_t i = 0; i < numAdmitted; i++)
         {
-#ifdef NC_Debug
-            DebugHandler::PrintError("Received Invalid Opcode Size (%u) from network stream", header->size);
-#endif // NC_Debug
-            break;
-        }
+            entt::entity entity = admittedEntities[i];
+            std::shared_ptr<NetClient>& netClient = admittedClients[i];
 
-        size_t sizeWithoutHeader = activeSize - sizeof(PacketHeader);
+            ConnectionComponent& connectionComponent = registry.emplace<ConnectionComponent>(entity);
+            registry.emplace<Authentication>(entity);
 
-        // We have received a valid header, but we have yet to receive the entire payload
-        if (sizeWithoutHeader < header->size)
-        {
-            buffer->Normalize();
-            break;
-        }
+            connectionComponent.netClient = netClient;
+            connectionComponent.channel = std::make_shared<NetworkChannel>(netClient, ReactorSingleton::GetToken(entity));
 
-        // Skip Header
-        buffer->SkipRead(sizeof(PacketHeader));
+            connectionComponent.netClient->SetEntity(entity);
+            connectionComponent.netClient->SetConnectionStatus(ConnectionStatus::AUTH_CHALLENGE);
 
-        std::shared_ptr<NetPacket> packet = NetPacket::Borrow();
-        {
-            // Header
+            if (reactorSingleton.ioThreadPool)
+            {
+                reactorSingleton.ioThreadPool->Add(connectionComponent.channel);
+            }
+            else
             {
-                packet->header = *header;
+                reactorSingleton.reactor.Register(netClient->GetSocket(), ReactorSingleton::GetToken(entity));
+                connectionComponent.channel->reactor = &reactorSingleton.reactor;
             }
 
-            // Payload
+            netClient = nullptr;
+        }
+
+#ifdef NC_Debug
+        size_t numWaiting = connectionDeferredSingleton.newConnectionQueue.size_approx();
+        if (numWaiting > 0)
+        {
+            DebugHandler::PrintWarning("[Network/Admission]: Admitted %u connections, %u still waiting", static_cast<u32>(numAdmitted), static_cast<u32>(numWaiting));
+        }
+#endif // NC_Debug
+    }
+
+    if (connectionDeferredSingleton.droppedConnectionQueue.size_approx() > 0)
+    {
+        entt::entity entity;
+        while (connectionDeferredSingleton.droppedConnectionQueue.try_dequeue(entity))
+        {
+            if (!registry.valid(entity))
+                continue;
+
+            if (ConnectionComponent* connectionComponent = registry.try_get<ConnectionComponent>(entity))
             {
-                if (packet->header.size)
+                if (reactorSingleton.ioThreadPool)
                 {
-                    packet->payload = Bytebuffer::Borrow<8192/*NETWORK_BUFFER_SIZE*/ >();
-                    packet->payload->size = packet->header.size;
-                    packet->payload->writtenData = packet->header.size;
-                    std::memcpy(packet->payload->GetDataPointer(), buffer->GetReadPointer(), packet->header.size);
-
-                    // Skip Payload
-                    buffer->SkipRead(header->size);
+                    reactorSingleton.ioThreadPool->Remove(connectionComponent->channel);
+                }
+                else
+                {
+                    reactorSingleton.reactor.Unregister(connectionComponent->netClient->GetSocket(), ReactorSingleton::GetToken(entity));
                 }
             }
 
-            connectionSingleton.packetQueue.enqueue(packet);
+            registry.destroy(entity);
         }
     }
+}
+
+void AuthCompletionSystem::Update(entt::registry& registry)
+{
+    ZoneScopedNC("AuthCompletionSystem::Update", tracy::Color::Blue);
+
+    AuthenticationSingleton& authenticationSingleton = registry.ctx<AuthenticationSingleton>();
 
-    // Only reset if we read everything that was written
-    if (buffer->GetActiveSize() == 0)
+    AuthCompletion completion;
+    while (authenticationSingleton.workers.TryGetCompletion(completion))
     {
-        buffer->Reset();
+        completion(registry);
     }
 }
 
-void ConnectionUpdateSystem::Self_HandleDisconnect(std::shared_ptr<NetClient> netClient)
+void ConnectionFlushSystem::Update(entt::registry& registry)
 {
-#ifdef NC_Debug
-    const NetSocket::ConnectionInfo& connectionInfo = netClient->GetSocket()->GetConnectionInfo();
-    DebugHandler::PrintWarning("[Network/Socket]: Disconnected from (%s, %u)", connectionInfo.ipAddrStr.c_str(), connectionInfo.port);
-#endif // NC_Debug
-}
+    ZoneScopedNC("ConnectionFlushSystem::Update", tracy::Color::Blue);
 
-void ConnectionDeferredSystem::Update(entt::registry& registry)
-{
-    ConnectionDeferredSingleton& connectionDeferredSingleton = registry.ctx<ConnectionDeferredSingleton>();
+    TimeSingleton& timeSingleton = registry.ctx<TimeSingleton>();
+    f32 time = timeSingleton.lifeTimeInS;
+    f32 deltaTime = timeSingleton.deltaTime;
 
-    if (connectionDeferredSingleton.newConnectionQueue.size_approx() > 0)
+    auto view = registry.view<ConnectionComponent>();
+    view.each([time, deltaTime](const auto entity, ConnectionComponent& connection)
     {
-        std::shared_ptr<NetClient> netClient;
-        while (connectionDeferredSingleton.newConnectionQueue.try_dequeue(netClient))
+        connection.sendBudget = std::min(connection.sendBudget + (CONNECTION_SEND_BYTES_PER_SECOND * deltaTime), static_cast<f32>(CONNECTION_SEND_BURST_BYTES));
+
+        for (PacketSendQueue& sendQueue : connection.sendQueues)
         {
-            entt::entity entity = registry.create();
+            sendQueue.Stamp(time);
+        }
 
-            ConnectionComponent& connectionComponent = registry.emplace<ConnectionComponent>(entity);
-            registry.emplace<Authentication>(entity);
+        if (!connection.channel->IsConnected())
+        {
+            for (PacketSendQueue& sendQueue : connection.sendQueues)
+            {
+                sendQueue.Clear();
+            }
 
-            connectionComponent.netClient = netClient;
+            return;
+        }
 
-            connectionComponent.netClient->SetEntity(entity);
-            connectionComponent.netClient->SetConnectionStatus(ConnectionStatus::AUTH_CHALLENGE);
+        // Slow consumers, whatever the client can't take stays in memory on our side so it has to be bounded
+        size_t queuedBytes = connection.GetQueuedBytes();
+        if (queuedBytes > CONNECTION_QUEUED_BYTES_BUDGET)
+        {
+            connection.overBudgetTime += deltaTime;
+
+            if (queuedBytes > CONNECTION_MAX_QUEUED_BYTES || connection.overBudgetTime >= CONNECTION_SLOW_CONSUMER_TIME)
+            {
+                DebugHandler::PrintWarning("[Network/Flush]: Disconnecting slow consumer (%u), %llu bytes queued for %.1f seconds", entt::to_integral(entity), static_cast<u64>(queuedBytes), connection.overBudgetTime);
+                connection.channel->Close();
+
+                for (PacketSendQueue& sendQueue : connection.sendQueues)
+                {
+                    sendQueue.Clear();
+                }
+
+                return;
+            }
+        }
+        else
+        {
+            connection.overBudgetTime = 0.0f;
         }
-    }
 
-    if (connectionDeferredSingleton.droppedConnectionQueue.size_approx() > 0)
-    {
-        entt::entity entity;
-        while (connectionDeferredSingleton.droppedConnectionQueue.try_dequeue(entity))
+        // The I/O thread can't get rid of what it already has, keep everything on the tick where updates for the same entity collapse
+        if (connection.IsBackedUp())
         {
-            registry.destroy(entity);
+            connection.GetSendQueue(PacketPriority::LOW).DropQueuedBefore(time - LOW_PRIORITY_STALE_TIME);
+            return;
         }
-    }
+
+        // Everything due this tick goes out in one write (or a few if it doesn't fit the write buffer)
+        // When an I/O thread owns the socket it does the coalescing and writing instead
+        PacketCoalescer coalescer(*connection.netClient);
+        auto send = [&connection, &coalescer](PacketSendQueue& sendQueue)
+        {
+            connection.sendBudget -= sendQueue.queuedBytes;
+
+            if (connection.channel->HasIOThread())
+            {
+                connection.channel->Send(sendQueue);
+            }
+            else
+            {
+                coalescer.Add(sendQueue);
+            }
+        };
+
+        // IMMEDIATE and HIGH are always due this tick, they still count against the budget
+        PacketPriority dueThisTick[] = { PacketPriority::IMMEDIATE, PacketPriority::HIGH };
+        for (PacketPriority priority : dueThisTick)
+        {
+            PacketSendQueue& sendQueue = connection.GetSendQueue(priority);
+            if (sendQueue.IsEmpty())
+                continue;
+
+            send(sendQueue);
+        }
+
+        struct Deadline
+        {
+            PacketPriority priority;
+            f32 time;
+        };
+
+        Deadline deadlines[] = { { PacketPriority::MEDIUM, MEDIUM_PRIORITY_TIME }, { PacketPriority::LOW, LOW_PRIORITY_TIME } };
+        for (const Deadline& deadline : deadlines)
+        {
+            PacketSendQueue& sendQueue = connection.GetSendQueue(deadline.priority);
+            if (sendQueue.IsEmpty() || time - sendQueue.GetOldestQueuedTime() < deadline.time)
+                continue;
+
+            // Out of budget, keep waiting but don't let stale low priority data pile up
+            if (connection.sendBudget <= 0.0f)
+            {
+                if (deadline.priority == PacketPriority::LOW)
+                    sendQueue.DropQueuedBefore(time - LOW_PRIORITY_STALE_TIME);
+
+                continue;
+            }
+
+            send(sendQueue);
+        }
+    });
 }
\ No newline at end of file
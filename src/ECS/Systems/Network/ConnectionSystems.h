@@ -2,6 +2,7 @@
 #include <entity/fwd.hpp>
 
 class NetClient;
+struct ConnectionComponent;
 namespace moddycamel
 {
     class ConcurrentQueue;
@@ -15,15 +16,32 @@ public:
     static bool Server_HandleConnect(std::shared_ptr<NetClient> netClient);
 
     // Handlers for Network Client
-    static void Client_HandleRead(std::shared_ptr<NetClient> netClient);
     static void Client_HandleDisconnect(std::shared_ptr<NetClient> netClient);
     static void Self_HandleConnect(std::shared_ptr<NetClient> netClient, bool connected);
-    static void Self_HandleRead(std::shared_ptr<NetClient> netClient);
     static void Self_HandleDisconnect(std::shared_ptr<NetClient> netClient);
+
+private:
+    static void UpdateSelf(entt::registry& registry);
+    static void UpdateClient(ConnectionComponent& connection);
+    static void HandleClientPackets(ConnectionComponent& connection);
 };
 
 class ConnectionDeferredSystem
 {
+public:
+    static void Update(entt::registry& registry);
+};
+
+// Applies the logins the auth workers finished since the last tick, their connections move on to the next auth status here
+class AuthCompletionSystem
+{
+public:
+    static void Update(entt::registry& registry);
+};
+
+// Outbound scheduler, runs every tick and writes every priority queue that is due, one write per connection
+class ConnectionFlushSystem
+{
 public:
     static void Update(entt::registry& registry);
 };
\ No newline at end of file
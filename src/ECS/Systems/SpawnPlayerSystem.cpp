@@ -11,6 +11,8 @@
 #include "../Components/Singletons/MapSingleton.h"
 #include "../Components/Singletons/SpawnPlayerQueueSingleton.h"
 #include "../Components/Network/ConnectionComponent.h"
+#include "../Components/Network/ReplicationComponent.h"
+#include "../Components/InterestComponent.h"
 
 #include <Gameplay/Network/PacketWriter.h>
 #include <Gameplay/ECS/Components/Transform.h>
@@ -33,18 +35,24 @@ void SpawnPlayerSystem::Update(entt::registry& registry)
         const std::shared_ptr<NetClient> client = request.client;
 
         // Make sure we discard the request if the client disconnected before we could get to it
-        if (!client->IsConnected())
+        const entt::entity entityID = client->GetEntity();
+        if (!registry.valid(entityID))
+            continue;
+
+        ConnectionComponent* connectionComponent = registry.try_get<ConnectionComponent>(entityID);
+        if (!connectionComponent || !connectionComponent->channel->IsConnected())
             continue;
 
         // Create Player & Notify
         {
-            const entt::entity entityID = client->GetEntity();
-            ConnectionComponent& connection = registry.get<ConnectionComponent>(entityID);
+            ConnectionComponent& connection = *connectionComponent;
 
             Transform& transform = registry.emplace<Transform>(entityID);
             GameEntity& gameEntity = registry.emplace<GameEntity>(entityID, GameEntity::Type::Player, 29344);
             registry.emplace<TransformIsDirty>(entityID);
             registry.emplace<GameEntityPlayerFlag>(entityID);
+            registry.emplace<InterestComponent>(entityID);
+            registry.emplace<ReplicationComponent>(entityID);
 
             EntityResources& resources = registry.emplace<EntityResources>(entityID);
             resources.current[static_cast<u8>(EntityResourceType::HEALTH)] = 100.f;
@@ -5,158 +5,367 @@
 #include <Utils/DebugHandler.h>
 #include "../../Utils/ServiceLocator.h"
 #include "../Components/Singletons/MapSingleton.h"
+#include "../Components/Singletons/VisibilitySingleton.h"
+#include "../Components/Singletons/TimeSingleton.h"
 #include "../Components/Network/ConnectionComponent.h"
+#include "../Components/Network/ReplicationComponent.h"
+#include "../Components/InterestComponent.h"
 
 #include <Gameplay/Network/PacketWriter.h>
 #include <Gameplay/ECS/Components/Transform.h>
 #include <Gameplay/ECS/Components/GameEntity.h>
 #include <Gameplay/ECS/Components/GameEntityPlayerFlag.h>
 
-void UpdateEntityPositionSystem::Update(entt::registry& registry)
+// Distinct delta baselines we keep packets for per subject, observers beyond that get a packet of their own
+#define MOVEMENT_PACKET_CACHE_SIZE 8
+
+// Every observer of a subject gets the same keyframe, and observers holding the same baseline (most of them, they got the same updates) the same delta
+struct MovementPacketCache
 {
-    auto playerView = registry.view<Transform, GameEntity, GameEntityPlayerFlag>();
+    entt::entity subject = entt::null;
+    const Transform* transform = nullptr;
+    QuantizedTransform quantizedTransform;
+
+    std::shared_ptr<Bytebuffer> keyframe = nullptr;
+    std::vector<std::pair<QuantizedTransform, std::shared_ptr<Bytebuffer>>> deltas;
+
+    void Reset(entt::entity newSubject, const Transform& newTransform)
+    {
+        subject = newSubject;
+        transform = &newTransform;
+        quantizedTransform = QuantizedTransform::FromTransform(newTransform);
+
+        keyframe = nullptr;
+        deltas.clear();
+    }
+
+    // A keyframe if baseline is null, returns null if the packet couldn't be built
+    std::shared_ptr<Bytebuffer> Get(const QuantizedTransform* baseline)
+    {
+#if MOVEMENT_QUANTIZED_UPDATES
+        if (baseline)
+        {
+            for (auto& delta : deltas)
+            {
+                if (delta.first == *baseline)
+                    return delta.second;
+            }
+
+            std::shared_ptr<Bytebuffer> packetBuffer = nullptr;
+            if (!MovementReplication::WriteUpdate(packetBuffer, subject, baseline, quantizedTransform))
+                return nullptr;
+
+            // Observers that fell behind each hold their own baseline, don't let them grow the search
+            if (deltas.size() < MOVEMENT_PACKET_CACHE_SIZE)
+                deltas.emplace_back(*baseline, packetBuffer);
+
+            return packetBuffer;
+        }
+
+        if (!keyframe && !MovementReplication::WriteUpdate(keyframe, subject, nullptr, quantizedTransform))
+            keyframe = nullptr;
+#else
+        if (!keyframe && !PacketWriter::SMSG_UPDATE_ENTITY(keyframe, subject, *transform))
+            keyframe = nullptr;
+#endif
+
+        return keyframe;
+    }
+};
+
+// Queues the subject's movement for one observer if the client can tell it apart from its baseline, or a keyframe once the last one is old enough
+static void SendMovementUpdate(ConnectionComponent& connection, ReplicationComponent& replication, MovementPacketCache& cache, f32 time)
+{
+    ReplicationBaseline* baseline = replication.GetBaseline(cache.subject);
+    bool isKeyframe = !baseline || time - baseline->keyframeTime >= MOVEMENT_KEYFRAME_TIME;
+
+    if (!isKeyframe && baseline->transform == cache.quantizedTransform)
+        return;
+
+    std::shared_ptr<Bytebuffer> packetBuffer = cache.Get(isKeyframe ? nullptr : &baseline->transform);
+    if (!packetBuffer)
+        return;
+
+#if MOVEMENT_QUANTIZED_UPDATES
+    // A delta only makes sense on top of every update before it, so unlike full updates they are never superseded while queued
+    connection.AddPacket(packetBuffer, PacketPriority::IMMEDIATE);
+#else
+    connection.AddPacket(packetBuffer, PacketPriority::IMMEDIATE, PacketSendQueue::GetSupersedeKey(Opcode::SMSG_UPDATE_ENTITY, entt::to_integral(cache.subject)));
+#endif
+
+    if (isKeyframe)
+    {
+        replication.SetBaseline(cache.subject, cache.quantizedTransform, time);
+    }
+    else
+    {
+        baseline->transform = cache.quantizedTransform;
+    }
+}
+
+static void GetWorkerRange(size_t numItems, u32 workerIndex, u32 numWorkers, size_t& begin, size_t& end)
+{
+    begin = (numItems * workerIndex) / numWorkers;
+    end = (numItems * (workerIndex + 1)) / numWorkers;
+}
+
+void UpdateEntityPositionSystem::Prepare(entt::registry& registry, u32 numWorkers)
+{
+    VisibilitySingleton& visibilitySingleton = registry.ctx<VisibilitySingleton>();
+    visibilitySingleton.players.clear();
+    visibilitySingleton.entityToPlayerIndex.clear();
+
+    if (visibilitySingleton.workerStaging.size() != numWorkers)
+        visibilitySingleton.workerStaging.resize(numWorkers);
+
+    auto playerView = registry.view<Transform, InterestComponent, GameEntityPlayerFlag>();
     if (playerView.size_hint() == 0)
         return;
 
+    playerView.each([&](const auto entity, Transform& transform, InterestComponent& interest)
+    {
+        u32 playerIndex = static_cast<u32>(visibilitySingleton.players.size());
+        visibilitySingleton.entityToPlayerIndex[entity] = playerIndex;
 
+        VisibilityPlayer& player = visibilitySingleton.players.emplace_back();
+        player.entity = entity;
+        player.position = vec2(transform.position.x, transform.position.y);
+        player.isDirty = registry.all_of<TransformIsDirty>(entity);
+        player.interest = &interest;
+    });
+}
+
+void UpdateEntityPositionSystem::UpdateVisibility(entt::registry& registry, u32 workerIndex, u32 numWorkers)
+{
+    constexpr f32 EnterDistanceSquared = SyncDistance * SyncDistance;
+    constexpr f32 LeaveDistance = SyncDistance + SyncHysteresis;
+
+    VisibilitySingleton& visibilitySingleton = registry.ctx<VisibilitySingleton>();
     MapSingleton& mapSingleton = registry.ctx<MapSingleton>();
-    playerView.each([&](const auto entity, Transform& transform, GameEntity& gameEntity)
+    const SpatialGrid& entityGrid = mapSingleton.GetEntityGrid();
+
+    VisibilityWorkerStaging& staging = visibilitySingleton.workerStaging[workerIndex];
+    std::vector<VisibilityRecord>& records = staging.records;
+    std::vector<VisibilityCandidate>& candidates = staging.candidates;
+    std::vector<entt::entity>& visibleEntities = staging.visibleEntities;
+
+    size_t begin, end;
+    GetWorkerRange(visibilitySingleton.players.size(), workerIndex, numWorkers, begin, end);
+    if (begin == end)
+        return;
+
+    // Query the whole slice at once
+    staging.queryPositions.clear();
+    for (size_t i = begin; i < end; i++)
     {
-        std::vector<Point2D> entitiesWithinDistance;
-        Tree2D& entityTree = mapSingleton.GetEntityTree();
-        if (!entityTree.GetWithinDistance({transform.position.x, transform.position.y}, SyncDistance, entity, entitiesWithinDistance))
-            return;
+        staging.queryPositions.push_back(visibilitySingleton.players[i].position);
+    }
 
-        std::vector<entt::entity>& seenEntities = gameEntity.seenEntities;
-        if (seenEntities.size() == 0 && entitiesWithinDistance.size() == 0)
-            return;
+    const RadiusQueryResults& queryResults = staging.queryResults;
+    entityGrid.GetWithinDistance(staging.queryPositions.data(), staging.queryPositions.size(), LeaveDistance, staging.queryResults);
+
+    for (size_t i = begin; i < end; i++)
+    {
+        const VisibilityPlayer& player = visibilitySingleton.players[i];
+        entt::entity entity = player.entity;
+        InterestComponent& interest = *player.interest;
 
-        std::vector<entt::entity> newlySeenEntities(entitiesWithinDistance.size());
-        for (u32 i = 0; i < entitiesWithinDistance.size(); i++)
+        size_t query = i - begin;
+        u32 numResults = queryResults.GetNumResults(query);
+        const entt::entity* resultEntities = queryResults.GetEntities(query);
+        const f32* resultDistancesSquared = queryResults.GetDistancesSquared(query);
+
+        candidates.clear();
+        for (u32 j = 0; j < numResults; j++)
         {
-            newlySeenEntities[i] = entitiesWithinDistance[i].GetPayload();
+            if (resultEntities[j] != entity)
+                candidates.push_back({ resultEntities[j], resultDistancesSquared[j] });
         }
 
-        ConnectionComponent& connection = registry.get<ConnectionComponent>(entity);
+        if (interest.visibleEntities.size() == 0 && candidates.size() == 0)
+            continue;
+
+        std::sort(candidates.begin(), candidates.end(), [](const VisibilityCandidate& a, const VisibilityCandidate& b) { return a.entity < b.entity; });
+        visibleEntities.clear();
+
+        // Both lists are sorted, so a single merge gives us the entering, staying and leaving entities
+        size_t visibleIndex = 0;
+        size_t candidateIndex = 0;
+        size_t numVisible = interest.visibleEntities.size();
+        size_t numCandidates = candidates.size();
 
-        // Send Delete Updates to no longer seen entites
+        while (visibleIndex < numVisible || candidateIndex < numCandidates)
         {
-            for (auto it = seenEntities.begin(); it != seenEntities.end();)
-            {
-                entt::entity seenEntity = *it;
+            bool hasVisible = visibleIndex < numVisible;
+            bool hasCandidate = candidateIndex < numCandidates;
 
-                auto itr = std::find(newlySeenEntities.begin(), newlySeenEntities.end(), seenEntity);
-                if (itr != newlySeenEntities.end())
-                {
-                    newlySeenEntities.erase(itr);
+            // Previously visible entity is no longer within LeaveDistance
+            if (hasVisible && (!hasCandidate || interest.visibleEntities[visibleIndex] < candidates[candidateIndex].entity))
+            {
+                records.push_back({ VisibilityRecord::Type::LEAVE, entity, interest.visibleEntities[visibleIndex++] });
+                continue;
+            }
 
-                    it++;
-                    continue;
-                }
+            const VisibilityCandidate& candidate = candidates[candidateIndex++];
 
-                // Remove SeenEntity
-                {
-                    it = seenEntities.erase(it);
-
-                    std::shared_ptr<Bytebuffer> packetBuffer = nullptr;
-                    if (PacketWriter::SMSG_DELETE_ENTITY(packetBuffer, seenEntity))
-                    {
-                        connection.AddPacket(packetBuffer, PacketPriority::IMMEDIATE);
-                    }
-                    else
-                    {
-                        DebugHandler::PrintError("Failed to build SMSG_DELETE_ENTITY");
-                    }
-                }
+            // Still visible
+            if (hasVisible && interest.visibleEntities[visibleIndex] == candidate.entity)
+            {
+                visibleEntities.push_back(candidate.entity);
+                visibleIndex++;
+                continue;
             }
+
+            // Not visible yet, only enter once inside SyncDistance so entities on the border don't flap
+            if (candidate.distanceSquared > EnterDistanceSquared)
+                continue;
+
+            records.push_back({ VisibilityRecord::Type::ENTER, entity, candidate.entity });
+            visibleEntities.push_back(candidate.entity);
         }
 
-        // Send our Movement Updates to other players.
-        if (seenEntities.size() > 0 && registry.all_of<TransformIsDirty>(entity))
+        interest.visibleEntities.swap(visibleEntities);
+    }
+}
+
+void UpdateEntityPositionSystem::GatherMovementUpdates(entt::registry& registry, u32 workerIndex, u32 numWorkers)
+{
+    VisibilitySingleton& visibilitySingleton = registry.ctx<VisibilitySingleton>();
+    std::vector<VisibilityRecord>& records = visibilitySingleton.workerStaging[workerIndex].records;
+
+    size_t begin, end;
+    GetWorkerRange(visibilitySingleton.players.size(), workerIndex, numWorkers, begin, end);
+
+    // All visible sets are final at this point and only read from here on
+    for (size_t i = begin; i < end; i++)
+    {
+        const VisibilityPlayer& player = visibilitySingleton.players[i];
+        if (!player.isDirty)
+            continue;
+
+        for (entt::entity seenEntity : player.interest->visibleEntities)
         {
-            std::shared_ptr<Bytebuffer> packetBuffer = nullptr;
-            if (PacketWriter::SMSG_UPDATE_ENTITY(packetBuffer, entity, transform))
-            {
-                for (u32 i = 0; i < seenEntities.size(); i++)
-                {
-                    entt::entity seenEntity = seenEntities[i];
-                    if (!registry.valid(seenEntity) || !registry.all_of<GameEntityPlayerFlag>(seenEntity))
-                        continue;
+            auto itr = visibilitySingleton.entityToPlayerIndex.find(seenEntity);
+            if (itr == visibilitySingleton.entityToPlayerIndex.end())
+                continue;
 
-                    ConnectionComponent& seenConnection = registry.get<ConnectionComponent>(seenEntity);
-                    seenConnection.AddPacket(packetBuffer, PacketPriority::IMMEDIATE);
-                }
-            }
-        }
+            const VisibilityPlayer& observer = visibilitySingleton.players[itr->second];
+            if (!observer.interest->IsVisible(player.entity))
+                continue;
 
-        // Check if there are any new entities
-        if (newlySeenEntities.size() == 0)
-            return;
+            records.push_back({ VisibilityRecord::Type::UPDATE, observer.entity, player.entity });
+        }
+    }
+}
 
-        // List of new entities within range
+void UpdateEntityPositionSystem::Merge(entt::registry& registry)
+{
+    VisibilitySingleton& visibilitySingleton = registry.ctx<VisibilitySingleton>();
+    f32 time = registry.ctx<TimeSingleton>().lifeTimeInS;
 
-        if (newlySeenEntities.size() > 0)
+    // Every worker's ENTER and LEAVE records go out before any UPDATE record, an observer that entered a subject on another worker's slice this tick
+    // must see SMSG_CREATE_ENTITY before the first movement update for it
+    for (VisibilityWorkerStaging& staging : visibilitySingleton.workerStaging)
+    {
+        for (const VisibilityRecord& record : staging.records)
         {
-            //DebugHandler::PrintSuccess("Preparing Data for Player (%u)", entt::to_integral(entity));
-            for (u32 i = 0; i < newlySeenEntities.size(); i++)
+            if (record.type == VisibilityRecord::Type::UPDATE)
+                continue;
+
+            ConnectionComponent& connection = registry.get<ConnectionComponent>(record.observer);
+            ReplicationComponent& replication = registry.get<ReplicationComponent>(record.observer);
+
+            if (record.type == VisibilityRecord::Type::LEAVE)
             {
-                entt::entity newEntity = newlySeenEntities[i];
+                std::shared_ptr<Bytebuffer> packetBuffer = nullptr;
+                if (PacketWriter::SMSG_DELETE_ENTITY(packetBuffer, record.subject))
+                {
+                    connection.AddPacket(packetBuffer, PacketPriority::IMMEDIATE);
+                }
+                else
+                {
+                    DebugHandler::PrintError("Failed to build SMSG_DELETE_ENTITY");
+                }
 
-                if (!registry.valid(newEntity))
+                replication.RemoveBaseline(record.subject);
+            }
+            else if (record.type == VisibilityRecord::Type::ENTER)
+            {
+                if (!registry.valid(record.subject))
                     continue;
 
-                const Transform& newTransform = registry.get<Transform>(newEntity);
-                const GameEntity& newGameEntity = registry.get<GameEntity>(newEntity);
+                const Transform& newTransform = registry.get<Transform>(record.subject);
+                const GameEntity& newGameEntity = registry.get<GameEntity>(record.subject);
 
                 std::shared_ptr<Bytebuffer> packetBuffer = nullptr;
-                
-                if (PacketWriter::SMSG_CREATE_ENTITY(packetBuffer, newEntity, newGameEntity, newTransform))
+                if (PacketWriter::SMSG_CREATE_ENTITY(packetBuffer, record.subject, newGameEntity, newTransform))
                 {
                     connection.AddPacket(packetBuffer, PacketPriority::IMMEDIATE);
+                    replication.SetBaseline(record.subject, QuantizedTransform::FromTransform(newTransform), time);
                 }
-
-                seenEntities.push_back(newEntity);
             }
-            //DebugHandler::PrintSuccess("Finished Preparing Data for Player (%u)", entt::to_integral(entity));
         }
-    });
+    }
 
-    auto entityView = registry.view<Transform, GameEntity, TransformIsDirty>(entt::exclude_t<GameEntityPlayerFlag>());
-    if (entityView.size_hint() == 0)
-        return;
-
-    entityView.each([&](const auto entity, Transform& transform, GameEntity& gameEntity)
+    for (VisibilityWorkerStaging& staging : visibilitySingleton.workerStaging)
     {
-        std::vector<Point2D> playersWithinDistance;
-        Tree2D& playerTree = mapSingleton.GetPlayerTree();
-        if (!playerTree.GetWithinDistance({ transform.position.x, transform.position.y }, SyncDistance, entity, playersWithinDistance))
-            return;
-
-        // TODO: We should not be sending these to newlySeenEntities as they just got the create packet.
-        std::vector<entt::entity>& seenEntities = gameEntity.seenEntities;
-        if (seenEntities.size() == 0 && playersWithinDistance.size() == 0)
-            return;
-        seenEntities.resize(playersWithinDistance.size());
-
-        for (u32 i = 0; i < playersWithinDistance.size(); i++)
+        // Update records for the same subject are staged back to back, so we only build each packet once
+        MovementPacketCache packetCache;
+
+        for (const VisibilityRecord& record : staging.records)
         {
-            seenEntities[i] = playersWithinDistance[i].GetPayload();
+            if (record.type != VisibilityRecord::Type::UPDATE)
+                continue;
+
+            if (record.subject != packetCache.subject)
+                packetCache.Reset(record.subject, registry.get<Transform>(record.subject));
+
+            ConnectionComponent& connection = registry.get<ConnectionComponent>(record.observer);
+            ReplicationComponent& replication = registry.get<ReplicationComponent>(record.observer);
+            SendMovementUpdate(connection, replication, packetCache, time);
         }
 
-        std::shared_ptr<Bytebuffer> packetBuffer = nullptr;
-        if (PacketWriter::SMSG_UPDATE_ENTITY(packetBuffer, entity, transform))
+        staging.records.clear();
+    }
+
+    auto entityView = registry.view<Transform, GameEntity, TransformIsDirty>(entt::exclude_t<GameEntityPlayerFlag>());
+    if (visibilitySingleton.players.size() > 0 && entityView.size_hint() > 0)
+    {
+        constexpr f32 LeaveDistance = SyncDistance + SyncHysteresis;
+
+        MapSingleton& mapSingleton = registry.ctx<MapSingleton>();
+        const SpatialGrid& playerGrid = mapSingleton.GetPlayerGrid();
+
+        MovementPacketCache packetCache;
+
+        entityView.each([&](const auto entity, Transform& transform, GameEntity& gameEntity)
         {
-            for (entt::entity seenEntity : seenEntities)
+            // Observers that just got SMSG_CREATE_ENTITY hold this exact state as their baseline, SendMovementUpdate skips them
+            std::vector<entt::entity>& seenEntities = gameEntity.seenEntities;
+            seenEntities.clear();
+
+            playerGrid.ForEachWithinDistance({ transform.position.x, transform.position.y }, LeaveDistance, [&visibilitySingleton, &seenEntities, entity](entt::entity player, f32 /*distanceSquared*/)
             {
-                if (!registry.valid(seenEntity) || !registry.all_of<GameEntityPlayerFlag>(seenEntity))
-                    continue;
+                auto itr = visibilitySingleton.entityToPlayerIndex.find(player);
+                if (itr == visibilitySingleton.entityToPlayerIndex.end())
+                    return;
 
+                if (visibilitySingleton.players[itr->second].interest->IsVisible(entity))
+                    seenEntities.push_back(player);
+            });
+
+            if (seenEntities.size() == 0)
+                return;
+
+            packetCache.Reset(entity, transform);
+            for (entt::entity seenEntity : seenEntities)
+            {
                 ConnectionComponent& seenConnection = registry.get<ConnectionComponent>(seenEntity);
-                seenConnection.AddPacket(packetBuffer, PacketPriority::IMMEDIATE);
+                ReplicationComponent& seenReplication = registry.get<ReplicationComponent>(seenEntity);
+                SendMovementUpdate(seenConnection, seenReplication, packetCache, time);
             }
-        }
-    });
+        });
+    }
 
-    // Testing
     registry.clear<TransformIsDirty>();
 }
\ No newline at end of file
@@ -2,10 +2,27 @@
 #include <NovusTypes.h>
 #include <entity/fwd.hpp>
 
+// Entities enter visibility at SyncDistance but only leave it beyond SyncDistance + VISIBILITY_SYNC_HYSTERESIS, override it at build time to tune
+#ifndef VISIBILITY_SYNC_HYSTERESIS
+#define VISIBILITY_SYNC_HYSTERESIS 25.0f
+#endif
+
 class UpdateEntityPositionSystem
 {
 public:
-    static void Update(entt::registry& registry);
+    // Runs serially, snapshots the players for the parallel phases
+    static void Prepare(entt::registry& registry, u32 numWorkers);
+
+    // Runs on every worker, diffs the visible set of the worker's slice of players
+    static void UpdateVisibility(entt::registry& registry, u32 workerIndex, u32 numWorkers);
+
+    // Runs on every worker once all visible sets are final, finds the observers of every moved player
+    static void GatherMovementUpdates(entt::registry& registry, u32 workerIndex, u32 numWorkers);
+
+    // Runs serially, turns the staged records into packets and sends creature movement
+    static void Merge(entt::registry& registry);
     
     static constexpr f32 SyncDistance = 500.f;
+
+    static constexpr f32 SyncHysteresis = VISIBILITY_SYNC_HYSTERESIS;
 };
\ No newline at end of file
@@ -0,0 +1,40 @@
+#include "UpdateSpatialGridSystem.h"
+#include <entt.hpp>
+#include <tracy/Tracy.hpp>
+
+#include "../Components/Singletons/MapSingleton.h"
+
+#include <Gameplay/ECS/Components/Transform.h>
+#include <Gameplay/ECS/Components/GameEntity.h>
+
+void UpdateSpatialGridSystem::Update(entt::registry& registry)
+{
+    // Only entities that moved since the last update need to be touched
+    auto dirtyView = registry.view<Transform, GameEntity, TransformIsDirty>();
+    if (dirtyView.size_hint() == 0)
+        return;
+
+    MapSingleton& mapSingleton = registry.ctx<MapSingleton>();
+    SpatialGrid& entityGrid = mapSingleton.GetEntityGrid();
+    SpatialGrid& playerGrid = mapSingleton.GetPlayerGrid();
+    Terrain::Map& currentMap = mapSingleton.GetCurrentMap();
+
+    dirtyView.each([&](const auto entity, Transform& transform, GameEntity& gameEntity)
+    {
+        currentMap.UpdateEntityChunk(entity, transform.position);
+
+        vec2 position = vec2(transform.position.x, transform.position.y);
+        entityGrid.Update(entity, position);
+
+        if (gameEntity.type == GameEntity::Type::Player)
+            playerGrid.Update(entity, position);
+    });
+}
+
+void UpdateSpatialGridSystem::HandleTransformDestroyed(entt::registry& registry, entt::entity entity)
+{
+    MapSingleton& mapSingleton = registry.ctx<MapSingleton>();
+    mapSingleton.GetCurrentMap().RemoveEntityChunk(entity);
+    mapSingleton.GetEntityGrid().Remove(entity);
+    mapSingleton.GetPlayerGrid().Remove(entity);
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+#pragma once
+#include <entity/fwd.hpp>
+
+class UpdateSpatialGridSystem
+{
+public:
+    static void Update(entt::registry& registry);
+
+    // Connected to on_destroy<Transform> so entities never linger in the grids or chunk lists
+    static void HandleTransformDestroyed(entt::registry& registry, entt::entity entity);
+};
\ No newline at end of file
@@ -1,8 +1,13 @@
 #include "EngineLoop.h"
 #include <thread>
+#include <algorithm>
+#include <cstdlib>
 #include <Utils/Timer.h>
 #include "Utils/ServiceLocator.h"
-#include <Networking/NetPacketHandler.h>
+#include "Network/NetworkIOThreadPool.h"
+#include "Network/PayloadPool.h"
+#include "Database/WorldSnapshot.h"
+#include "Database/CreatureLoader.h"
 #include <tracy/Tracy.hpp>
 
 // Component Singletons
@@ -10,26 +15,23 @@
 #include "ECS/Components/Singletons/TimeSingleton.h"
 #include "ECS/Components/Singletons/MapSingleton.h"
 #include "ECS/Components/Singletons/TeleportSingleton.h"
+#include "ECS/Components/Singletons/VisibilitySingleton.h"
 #include "ECS/Components/Network/ConnectionSingleton.h"
 #include "ECS/Components/Network/ConnectionDeferredSingleton.h"
 #include "ECS/Components/Network/AuthenticationSingleton.h"
+#include "ECS/Components/Network/ReactorSingleton.h"
 
 // Components
+#include "ECS/Components/Network/ConnectionComponent.h"
 
 // Systems
 #include "ECS/Systems/SpawnPlayerSystem.h"
+#include "ECS/Systems/DBCompletionSystem.h"
 #include "ECS/Systems/CreatureMovementSystem.h"
 #include "ECS/Systems/UpdateEntityPositionSystem.h"
-#include "ECS/Systems/CreatePlayerTreeSystem.h"
+#include "ECS/Systems/UpdateSpatialGridSystem.h"
 #include "ECS/Systems/Network/ConnectionSystems.h"
 
-// Handlers
-#include "Network/Handlers/Self/Auth/AuthHandlers.h"
-#include "Network/Handlers/Self/GeneralHandlers.h"
-#include "Network/Handlers/Client/Auth/AuthHandlers.h"
-#include "Network/Handlers/Client/GeneralHandlers.h"
-
-#include <Containers/KDTree.h>
 #include <Gameplay/ECS/Components/Transform.h>
 #include <Gameplay/ECS/Components/GameEntity.h>
 
@@ -59,6 +61,7 @@ EngineLoop::EngineLoop()
     clientSocket->SetReceiveBufferSize(8192);
 
     _network.server = std::make_shared<NetServer>();
+    _network.ioThreadPool = std::make_shared<NetworkIOThreadPool>();
 }
 
 EngineLoop::~EngineLoop()
@@ -104,17 +107,39 @@ void EngineLoop::Run()
 
     DBSingleton& dbSingleton = _updateFramework.gameRegistry.set<DBSingleton>();
     dbSingleton.auth.Connect("localhost", 3306, "root", "ascent", "novuscore", 0);
+    dbSingleton.workers.Start(DB_WORKER_COUNT, [](DBConnection& connection)
+    {
+        connection.Connect("localhost", 3306, "root", "ascent", "novuscore", 0);
+    });
 
     TimeSingleton& timeSingleton = _updateFramework.gameRegistry.set<TimeSingleton>();
     MapSingleton& mapSingleton = _updateFramework.gameRegistry.set<MapSingleton>();
+    VisibilitySingleton& visibilitySingleton = _updateFramework.gameRegistry.set<VisibilitySingleton>();
     ConnectionSingleton& connectionSingleton = _updateFramework.gameRegistry.set<ConnectionSingleton>();
     ConnectionDeferredSingleton& connectionDeferredSingleton = _updateFramework.gameRegistry.set<ConnectionDeferredSingleton>();
     AuthenticationSingleton& authenticationSingleton = _updateFramework.gameRegistry.set<AuthenticationSingleton>();
+    authenticationSingleton.workers.Start(AUTH_WORKER_COUNT);
+    ReactorSingleton& reactorSingleton = _updateFramework.gameRegistry.set<ReactorSingleton>();
+
+    _updateFramework.gameRegistry.on_destroy<Transform>().connect<&UpdateSpatialGridSystem::HandleTransformDestroyed>();
 
     connectionSingleton.netClient = _network.client;
+    connectionSingleton.channel = std::make_shared<NetworkChannel>(_network.client, SocketReactor::SELF_TOKEN, true);
+    connectionSingleton.channel->isAuthenticated = true; // We trust the auth server, it gets a full receive ring from the start
     bool didConnect = connectionSingleton.netClient->Connect("127.0.0.1", 8000);
     ConnectionUpdateSystem::Self_HandleConnect(connectionSingleton.netClient, didConnect);
 
+    if (didConnect)
+    {
+        reactorSingleton.reactor.Register(connectionSingleton.netClient->GetSocket(), SocketReactor::SELF_TOKEN);
+        connectionSingleton.channel->reactor = &reactorSingleton.reactor;
+    }
+
+    if (NETWORK_IO_THREAD_COUNT > 0 && _network.ioThreadPool->Start(NETWORK_IO_THREAD_COUNT, NETWORK_IO_BACKEND))
+    {
+        reactorSingleton.ioThreadPool = _network.ioThreadPool;
+    }
+
     connectionDeferredSingleton.netServer = _network.server;
     connectionDeferredSingleton.netServer->SetOnConnectCallback(ConnectionUpdateSystem::Server_HandleConnect);
     if (!_network.server->Init(NetSocket::Mode::TCP, "127.0.0.1", 4500))
@@ -139,6 +164,8 @@ void EngineLoop::Run()
         if (!Update())
             break;
 
+        timeSingleton.longestUpdateInS = std::max(timeSingleton.longestUpdateInS, timer.GetDeltaTime());
+
         {
             ZoneScopedNC("WaitForTickRate", tracy::Color::AntiqueWhite1)
 
@@ -162,6 +189,12 @@ void EngineLoop::Run()
     }
 
     // Clean up stuff here
+    _network.ioThreadPool->Stop();
+
+    // Batched writes go to the workers first, stopping them finishes everything queued
+    dbSingleton.teleportLocations.Flush();
+    dbSingleton.workers.Stop();
+    authenticationSingleton.workers.Stop();
 
     Message exitMessage;
     exitMessage.code = MSG_OUT_EXIT_CONFIRM;
@@ -192,6 +225,49 @@ bool EngineLoop::Update()
                 pongMessage.message = new std::string("PONG!");
                 _outputQueue.enqueue(pongMessage);
             }
+            else if (message.code == MSG_IN_PAYLOAD_STATS)
+            {
+                for (u32 i = 0; i < PAYLOAD_POOL_NUM_CLASSES; i++)
+                {
+                    const PayloadPoolStats& stats = PayloadPool::GetStats(i);
+                    PrintMessage("Payloads (%u bytes): %llu in use, %llu peak, %llu borrowed", static_cast<u32>(PayloadPool::CLASS_SIZES[i]), stats.numInUse.load(), stats.peakInUse.load(), stats.numBorrowed.load());
+                }
+            }
+            else if (message.code == MSG_IN_QUEUE_STATS)
+            {
+                PrintQueueStats();
+            }
+            else if (message.code == MSG_IN_AUTH_STATS)
+            {
+                PrintAuthStats();
+            }
+            else if (message.code == MSG_IN_ACCOUNT_CACHE)
+            {
+                std::vector<std::string> subCommands;
+                if (message.message)
+                {
+                    subCommands = StringUtils::SplitString(*message.message);
+                    delete message.message;
+                }
+
+                HandleAccountCacheCommand(subCommands);
+            }
+            else if (message.code == MSG_IN_DB_LATENCY)
+            {
+                DBSingleton& dbSingleton = _updateFramework.gameRegistry.ctx<DBSingleton>();
+                DBWorkerPool& dbWorkers = dbSingleton.workers;
+
+                if (message.message)
+                {
+                    dbWorkers.SetInjectedLatency(static_cast<u32>(std::strtoul(message.message->c_str(), nullptr, 10)));
+                    delete message.message;
+                }
+
+                PrintMessage("DB Latency: %u ms injected, %llu requests pending", dbWorkers.GetInjectedLatency(), static_cast<u64>(dbWorkers.GetNumPending()));
+
+                DBWriteBehind& teleportLocations = dbSingleton.teleportLocations;
+                PrintMessage("DB Write Behind: %llu teleport locations in %llu statements, %llu failed, %u batched", teleportLocations.GetNumFlushed(), teleportLocations.GetNumStatements(), teleportLocations.GetNumFailed(), teleportLocations.GetNumBatched());
+            }
         }
     }
 
@@ -199,13 +275,110 @@ bool EngineLoop::Update()
     return true;
 }
 
+void EngineLoop::PrintQueueStats()
+{
+    entt::registry& registry = _updateFramework.gameRegistry;
+    f32 time = registry.ctx<TimeSingleton>().lifeTimeInS;
+
+    struct QueueStats
+    {
+        entt::entity entity;
+        size_t queuedBytes;
+        size_t pendingSendBytes;
+        f32 age;
+        f32 overBudgetTime;
+        u64 numCollapsed;
+    };
+
+    std::vector<QueueStats> queueStats;
+    size_t totalQueuedBytes = 0;
+    u32 numOverBudget = 0;
+
+    auto view = registry.view<ConnectionComponent>();
+    view.each([&](const auto entity, ConnectionComponent& connection)
+    {
+        QueueStats& stats = queueStats.emplace_back();
+        stats.entity = entity;
+        stats.queuedBytes = connection.GetQueuedBytes();
+        stats.pendingSendBytes = connection.channel->pendingSendBytes.load();
+
+        f32 oldestQueuedTime = connection.GetOldestQueuedTime();
+        stats.age = oldestQueuedTime >= 0.0f ? time - oldestQueuedTime : 0.0f;
+        stats.overBudgetTime = connection.overBudgetTime;
+
+        stats.numCollapsed = 0;
+        for (const PacketSendQueue& sendQueue : connection.sendQueues)
+        {
+            stats.numCollapsed += sendQueue.numCollapsed;
+        }
+
+        totalQueuedBytes += stats.queuedBytes;
+        numOverBudget += stats.queuedBytes > CONNECTION_QUEUED_BYTES_BUDGET;
+    });
+
+    PrintMessage("Outbound Queues: %u connections, %llu bytes queued, %u over budget", static_cast<u32>(queueStats.size()), static_cast<u64>(totalQueuedBytes), numOverBudget);
+
+    // Only the deepest queues are interesting
+    constexpr size_t MaxPrinted = 10;
+    size_t numPrinted = std::min(queueStats.size(), MaxPrinted);
+    std::partial_sort(queueStats.begin(), queueStats.begin() + numPrinted, queueStats.end(), [](const QueueStats& a, const QueueStats& b) { return a.queuedBytes > b.queuedBytes; });
+
+    for (size_t i = 0; i < numPrinted; i++)
+    {
+        const QueueStats& stats = queueStats[i];
+        PrintMessage("Connection (%u): %llu bytes queued (%llu on I/O thread), oldest %.2fs, over budget %.1fs, %llu collapsed", entt::to_integral(stats.entity), static_cast<u64>(stats.queuedBytes), static_cast<u64>(stats.pendingSendBytes), stats.age, stats.overBudgetTime, stats.numCollapsed);
+    }
+}
+
+void EngineLoop::PrintAuthStats()
+{
+    entt::registry& registry = _updateFramework.gameRegistry;
+    AuthenticationSingleton& authenticationSingleton = registry.ctx<AuthenticationSingleton>();
+    TimeSingleton& timeSingleton = registry.ctx<TimeSingleton>();
+    const AuthWorkerPool& workers = authenticationSingleton.workers;
+
+    f32 elapsed = timeSingleton.lifeTimeInS - _authStatsTime;
+    f32 loginsPerSecond = elapsed > 0.0f ? static_cast<f32>(authenticationSingleton.numLogins - _authStatsNumLogins) / elapsed : 0.0f;
+
+    u64 numJobs = workers.GetNumCompleted();
+    f32 msPerJob = numJobs > 0 ? static_cast<f32>(workers.GetJobTimeUS()) / static_cast<f32>(numJobs) / 1000.0f : 0.0f;
+
+    PrintMessage("Auth: %llu logins, %llu failed, %.1f logins/s over the last %.1fs", authenticationSingleton.numLogins, authenticationSingleton.numFailedLogins, loginsPerSecond, elapsed);
+    PrintMessage("Auth Workers: %llu jobs pending, %llu done, %.3f ms per job, longest tick %.2f ms", static_cast<u64>(workers.GetNumPending()), numJobs, msPerJob, timeSingleton.longestUpdateInS * 1000.0f);
+
+    _authStatsTime = timeSingleton.lifeTimeInS;
+    _authStatsNumLogins = authenticationSingleton.numLogins;
+    timeSingleton.longestUpdateInS = 0.0f;
+}
+
+void EngineLoop::HandleAccountCacheCommand(const std::vector<std::string>& subCommands)
+{
+    AccountCache& accountCache = _updateFramework.gameRegistry.ctx<AuthenticationSingleton>().accountCache;
+
+    if (subCommands.size() >= 2 && subCommands[0] == "invalidate")
+    {
+        bool wasCached = accountCache.Invalidate(subCommands[1]);
+        PrintMessage("Account Cache: %s %s", subCommands[1].c_str(), wasCached ? "invalidated" : "wasn't cached");
+    }
+    else if (subCommands.size() >= 1 && subCommands[0] == "clear")
+    {
+        accountCache.Clear();
+        PrintMessage("Account Cache: Cleared");
+    }
+
+    u64 numHits = accountCache.GetNumHits();
+    u64 numLookups = numHits + accountCache.GetNumMisses();
+    f32 hitRate = numLookups > 0 ? static_cast<f32>(numHits) / static_cast<f32>(numLookups) * 100.0f : 0.0f;
+
+    PrintMessage("Account Cache: %llu accounts, %llu hits, %llu misses (%.1f%% hit rate), %llu invalidated, %llu evicted", static_cast<u64>(accountCache.GetNumEntries()), numHits, accountCache.GetNumMisses(), hitRate, accountCache.GetNumInvalidations(), accountCache.GetNumEvictions());
+}
+
 void EngineLoop::SetupUpdateFramework()
 {
     tf::Framework& framework = _updateFramework.framework;
     entt::registry& registry = _updateFramework.gameRegistry;
 
     ServiceLocator::SetRegistry(&registry);
-    SetMessageHandler();
     
     // SpawnPlayerSystem
     tf::Task spawnPlayerSystemTask = framework.emplace([&registry]()
@@ -222,13 +395,59 @@ void EngineLoop::SetupUpdateFramework()
     });
     creatureMovementSystemTask.gather(spawnPlayerSystemTask);
 
+    // UpdateSpatialGridSystem
+    tf::Task updateSpatialGridSystemTask = framework.emplace([&registry]()
+    {
+        ZoneScopedNC("UpdateSpatialGridSystem::Update", tracy::Color::Blue2);
+        UpdateSpatialGridSystem::Update(registry);
+    });
+    updateSpatialGridSystemTask.gather(creatureMovementSystemTask);
+
     // UpdateEntityPositionSystem
+    // Every player's visibility is independent, so the per player work is split into one task per executor worker
+    u32 numVisibilityWorkers = std::max(static_cast<u32>(_updateFramework.taskflow.num_workers()), 1u);
+
+    tf::Task updateEntityPositionPrepareTask = framework.emplace([&registry, numVisibilityWorkers]()
+    {
+        ZoneScopedNC("UpdateEntityPositionSystem::Prepare", tracy::Color::Blue2);
+        UpdateEntityPositionSystem::Prepare(registry, numVisibilityWorkers);
+    });
+    updateEntityPositionPrepareTask.gather(updateSpatialGridSystemTask);
+
     tf::Task updateEntityPositionSystemTask = framework.emplace([&registry]()
     {
-        ZoneScopedNC("UpdateEntityPositionSystem::Update", tracy::Color::Blue2);
-        UpdateEntityPositionSystem::Update(registry);
+        ZoneScopedNC("UpdateEntityPositionSystem::Merge", tracy::Color::Blue2);
+        UpdateEntityPositionSystem::Merge(registry);
     });
-    updateEntityPositionSystemTask.gather(creatureMovementSystemTask);
+
+    std::vector<tf::Task> updateVisibilityTasks;
+    updateVisibilityTasks.reserve(numVisibilityWorkers);
+    for (u32 i = 0; i < numVisibilityWorkers; i++)
+    {
+        tf::Task updateVisibilityTask = framework.emplace([&registry, i, numVisibilityWorkers]()
+        {
+            ZoneScopedNC("UpdateEntityPositionSystem::UpdateVisibility", tracy::Color::Blue2);
+            UpdateEntityPositionSystem::UpdateVisibility(registry, i, numVisibilityWorkers);
+        });
+        updateVisibilityTask.gather(updateEntityPositionPrepareTask);
+        updateVisibilityTasks.push_back(updateVisibilityTask);
+    }
+
+    for (u32 i = 0; i < numVisibilityWorkers; i++)
+    {
+        tf::Task gatherMovementUpdatesTask = framework.emplace([&registry, i, numVisibilityWorkers]()
+        {
+            ZoneScopedNC("UpdateEntityPositionSystem::GatherMovementUpdates", tracy::Color::Blue2);
+            UpdateEntityPositionSystem::GatherMovementUpdates(registry, i, numVisibilityWorkers);
+        });
+
+        // Movement updates read every player's visible set, so all visibility tasks have to be done
+        for (tf::Task& updateVisibilityTask : updateVisibilityTasks)
+        {
+            gatherMovementUpdatesTask.gather(updateVisibilityTask);
+        }
+        updateEntityPositionSystemTask.gather(gatherMovementUpdatesTask);
+    }
 
     // ConnectionUpdateSystem
     tf::Task connectionUpdateSystemTask = framework.emplace([&registry]()
@@ -238,101 +457,124 @@ void EngineLoop::SetupUpdateFramework()
     });
     connectionUpdateSystemTask.gather(updateEntityPositionSystemTask);
 
+    // DBCompletionSystem
+    tf::Task dbCompletionSystemTask = framework.emplace([&registry]()
+    {
+        ZoneScopedNC("DBCompletionSystem::Update", tracy::Color::Blue2)
+        DBCompletionSystem::Update(registry);
+    });
+    dbCompletionSystemTask.gather(connectionUpdateSystemTask);
+
+    // AuthCompletionSystem
+    tf::Task authCompletionSystemTask = framework.emplace([&registry]()
+    {
+        ZoneScopedNC("AuthCompletionSystem::Update", tracy::Color::Blue2)
+        AuthCompletionSystem::Update(registry);
+    });
+    authCompletionSystemTask.gather(dbCompletionSystemTask);
+
     // ConnectionDeferredSystem
     tf::Task connectionDeferredSystemTask = framework.emplace([&registry]()
     {
         ZoneScopedNC("ConnectionDeferredSystem::Update", tracy::Color::Blue2)
         ConnectionDeferredSystem::Update(registry);
     });
-    connectionDeferredSystemTask.gather(connectionUpdateSystemTask);
+    connectionDeferredSystemTask.gather(authCompletionSystemTask);
 
-    // CreatePlayerTreeSystem
-    tf::Task createPlayerTreeSystemTask = framework.emplace([&registry]()
+    // ConnectionFlushSystem
+    tf::Task connectionFlushSystemTask = framework.emplace([&registry]()
     {
-        ZoneScopedNC("CreatePlayerTreeSystem::Update", tracy::Color::Blue2);
-        CreatePlayerTreeSystem::Update(registry);
+        ZoneScopedNC("ConnectionFlushSystem::Update", tracy::Color::Blue2)
+        ConnectionFlushSystem::Update(registry);
     });
-    createPlayerTreeSystemTask.gather(connectionDeferredSystemTask);
-}
-void EngineLoop::SetMessageHandler()
-{
-    NetPacketHandler* selfNetPacketHandler = new NetPacketHandler();
-    ServiceLocator::SetSelfNetPacketHandler(selfNetPacketHandler);
-    InternalSocket::AuthHandlers::Setup(selfNetPacketHandler);
-    InternalSocket::GeneralHandlers::Setup(selfNetPacketHandler);
-
-    NetPacketHandler* clientNetPacketHandler = new NetPacketHandler();
-    ServiceLocator::SetClientNetPacketHandler(clientNetPacketHandler);
-    Client::AuthHandlers::Setup(clientNetPacketHandler);
-    Client::GeneralHandlers::Setup(clientNetPacketHandler);
+    connectionFlushSystemTask.gather(connectionDeferredSystemTask);
 }
 void EngineLoop::LoadDataFromDB()
-{
-    LoadCreatureDataFromDB();
-    LoadTeleportLocationsFromDB();
-}
-void EngineLoop::LoadCreatureDataFromDB()
 {
     DBSingleton& dbSingleton = _updateFramework.gameRegistry.ctx<DBSingleton>();
+    _updateFramework.gameRegistry.set<TeleportSingleton>();
 
-    std::string query = "SELECT * FROM creatures;";
-
-    std::shared_ptr<QueryResult> result = dbSingleton.auth.Query(query);
+    Timer timer;
 
-    u64 numAffectedRows = result->GetAffectedRows();
-    DebugHandler::PrintSuccess("Fetching Creatures...");
+    // Without a world version there is no telling if a snapshot is stale, so it is neither used nor written
+    WorldSnapshotSource source;
+    bool hasSource = WorldSnapshot::QuerySource(dbSingleton.auth, source);
 
-    if (numAffectedRows != 0)
+    if (hasSource)
     {
-        while (result->GetNextRow())
+        WorldSnapshot snapshot;
+        if (snapshot.Open(WORLD_SNAPSHOT_PATH, source))
         {
-            //const Field& idField = result->GetField(0);
-            const Field& entryField = result->GetField(1);
-            const Field& nameField = result->GetField(2);
-            const Field& subNameField = result->GetField(3);
-            const Field& displayIDField = result->GetField(4);
-            const Field& scaleField = result->GetField(5);
-            const Field& positionXField = result->GetField(6);
-            const Field& positionYField = result->GetField(7);
-            const Field& positionZField = result->GetField(8);
-            const Field& orientationField = result->GetField(9);
-
-            u32 entry = entryField.GetU32();
-            std::string name = nameField.GetString();
-            std::string subName = subNameField.GetString();
-            u32 displayID = displayIDField.GetU32();
-            f32 scale = scaleField.GetF32();
-            vec3 position = vec3(positionXField.GetF32(), positionYField.GetF32(), positionZField.GetF32());
-            f32 orientation = orientationField.GetF32();
-
-            entt::entity entityID = _updateFramework.gameRegistry.create();
-            Transform& transform = _updateFramework.gameRegistry.emplace<Transform>(entityID);
-
-            transform.position = position;
-            transform.scale *= scale;
-            transform.rotation.z = glm::degrees(orientation);
-
-            GameEntity& gameEntity = _updateFramework.gameRegistry.emplace<GameEntity>(entityID, GameEntity::Type::Creature, displayID);
-            _updateFramework.gameRegistry.emplace<TransformIsDirty>(entityID);
+            LoadDataFromSnapshot(snapshot);
+            DebugHandler::PrintSuccess("Loaded static world from %s (%.2f ms).", WORLD_SNAPSHOT_PATH, timer.GetLifeTime() * 1000.0f);
+            return;
         }
     }
 
-    DebugHandler::PrintSuccess("Added %u Creatures.", numAffectedRows);
+    std::vector<SnapshotCreature> creatures;
+    std::vector<TeleportLocation> teleportLocations;
+    bool didLoadCreatures = CreatureLoader::Load(dbSingleton.auth, dbSingleton.workers, _updateFramework.gameRegistry, creatures);
+    bool didLoadTeleportLocations = LoadTeleportLocationsFromDB(teleportLocations);
+
+    DebugHandler::PrintSuccess("Loaded static world from the database (%.2f ms).", timer.GetLifeTime() * 1000.0f);
+
+    // A partial load tagged with the current world version would pass Open() on every later start, so only a complete one is kept
+    if (!didLoadCreatures || !didLoadTeleportLocations)
+    {
+        DebugHandler::PrintWarning("Static world is incomplete, not writing %s", WORLD_SNAPSHOT_PATH);
+        return;
+    }
+
+    if (hasSource && !WorldSnapshot::Write(WORLD_SNAPSHOT_PATH, source, creatures, teleportLocations))
+    {
+        DebugHandler::PrintWarning("Failed to write %s, the next start loads from the database again", WORLD_SNAPSHOT_PATH);
+    }
 }
-void EngineLoop::LoadTeleportLocationsFromDB()
+void EngineLoop::LoadDataFromSnapshot(const WorldSnapshot& snapshot)
+{
+    entt::registry& registry = _updateFramework.gameRegistry;
+
+    // Creatures are read in place from the mapped file
+    u32 numCreatures = snapshot.GetNumCreatures();
+    registry.reserve(registry.size() + numCreatures);
+    registry.reserve<Transform, GameEntity, TransformIsDirty>(numCreatures);
+
+    for (u32 i = 0; i < numCreatures; i += CREATURE_LOAD_CHUNK_SIZE)
+    {
+        CreatureLoader::Insert(registry, snapshot.GetCreatures() + i, std::min<size_t>(numCreatures - i, CREATURE_LOAD_CHUNK_SIZE));
+    }
+
+    std::vector<TeleportLocation> teleportLocations;
+    if (!snapshot.ReadTeleportLocations(teleportLocations))
+    {
+        DebugHandler::PrintWarning("Snapshot teleport locations are truncated, loaded %u of them", static_cast<u32>(teleportLocations.size()));
+    }
+
+    AddTeleportLocations(teleportLocations);
+
+    DebugHandler::PrintSuccess("Added %u Creatures.", numCreatures);
+    DebugHandler::PrintSuccess("Added %u Teleport Locations.", static_cast<u32>(teleportLocations.size()));
+}
+bool EngineLoop::LoadTeleportLocationsFromDB(std::vector<TeleportLocation>& teleportLocations)
 {
     DBSingleton& dbSingleton = _updateFramework.gameRegistry.ctx<DBSingleton>();
-    TeleportSingleton& teleportSingleton = _updateFramework.gameRegistry.set<TeleportSingleton>();
 
     std::string query = "SELECT * FROM teleportlocations;";
 
     std::shared_ptr<QueryResult> result = dbSingleton.auth.Query(query);
+    if (!result)
+    {
+        DebugHandler::PrintError("Failed to load teleport locations");
+        return false;
+    }
 
     u64 numAffectedRows = result->GetAffectedRows();
     DebugHandler::PrintSuccess("Fetching Teleport Locations...");
 
     if (numAffectedRows != 0)
     {
+        teleportLocations.reserve(numAffectedRows);
+
         while (result->GetNextRow())
         {
             //const Field& idField = result->GetField(0);
@@ -343,18 +585,28 @@ void EngineLoop::LoadTeleportLocationsFromDB()
             const Field& positionZField = result->GetField(5);
             const Field& orientationField = result->GetField(6);
 
-            TeleportLocation teleportLocation;
+            TeleportLocation& teleportLocation = teleportLocations.emplace_back();
             teleportLocation.name = nameField.GetString();
             teleportLocation.mapId = mapIdField.GetU32();
             teleportLocation.position = vec3(positionXField.GetF32(), positionYField.GetF32(), positionZField.GetF32());
             teleportLocation.orientation = orientationField.GetF32();
-
-            u32 nameHash = StringUtils::fnv1a_32(teleportLocation.name.c_str(), teleportLocation.name.length());
-            teleportSingleton.nameHashToLocation[nameHash] = teleportLocation;
         }
     }
 
+    AddTeleportLocations(teleportLocations);
+
     DebugHandler::PrintSuccess("Added %u Teleport Locations.", numAffectedRows);
+    return teleportLocations.size() == numAffectedRows;
+}
+void EngineLoop::AddTeleportLocations(const std::vector<TeleportLocation>& teleportLocations)
+{
+    TeleportSingleton& teleportSingleton = _updateFramework.gameRegistry.ctx<TeleportSingleton>();
+
+    for (const TeleportLocation& teleportLocation : teleportLocations)
+    {
+        u32 nameHash = StringUtils::fnv1a_32(teleportLocation.name.c_str(), teleportLocation.name.length());
+        teleportSingleton.nameHashToLocation[nameHash] = teleportLocation;
+    }
 }
 
 void EngineLoop::UpdateSystems()
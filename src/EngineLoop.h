@@ -36,6 +36,16 @@ namespace tf
 class Framework;
 }
 
+// World server specific messages, offset so they never collide with the ones in Utils/Message.h
+enum WorldInputMessage
+{
+    MSG_IN_PAYLOAD_STATS = 1001,
+    MSG_IN_QUEUE_STATS = 1002,
+    MSG_IN_DB_LATENCY = 1003,
+    MSG_IN_AUTH_STATS = 1004,
+    MSG_IN_ACCOUNT_CACHE = 1005
+};
+
 struct FrameworkRegistryPair
 {
     entt::registry gameRegistry;
@@ -43,10 +53,16 @@ struct FrameworkRegistryPair
     tf::Taskflow taskflow;
 };
 
+class NetworkIOThreadPool;
+class WorldSnapshot;
+struct SnapshotCreature;
+struct TeleportLocation;
+
 struct NetworkPair
 {
     std::shared_ptr<NetClient> client;
     std::shared_ptr<NetServer> server;
+    std::shared_ptr<NetworkIOThreadPool> ioThreadPool;
 };
 
 class EngineLoop
@@ -79,11 +95,15 @@ private:
     void UpdateSystems();
 
     void SetupUpdateFramework();
-    void SetMessageHandler();
+    void PrintQueueStats();
+    void PrintAuthStats();
+    void HandleAccountCacheCommand(const std::vector<std::string>& subCommands);
 
+    // Loads from the snapshot if it is still up to date, otherwise from the database and writes a new snapshot
     void LoadDataFromDB();
-    void LoadCreatureDataFromDB();
-    void LoadTeleportLocationsFromDB();
+    void LoadDataFromSnapshot(const WorldSnapshot& snapshot);
+    bool LoadTeleportLocationsFromDB(std::vector<TeleportLocation>& teleportLocations);
+    void AddTeleportLocations(const std::vector<TeleportLocation>& teleportLocations);
 private:
     bool _isRunning;
 
@@ -91,4 +111,8 @@ private:
     moodycamel::ConcurrentQueue<Message> _outputQueue;
     FrameworkRegistryPair _updateFramework;
     NetworkPair _network;
+
+    // Where the last "auth" command left off, logins per second are measured between two of them
+    f32 _authStatsTime = 0.0f;
+    u64 _authStatsNumLogins = 0;
 };
@@ -1,7 +1,71 @@
 #include "Map.h"
+#include <algorithm>
 
 namespace Terrain
 {
+    static u16 ClampChunkCoordinate(f32 chunkCoordinate)
+    {
+        i32 coordinate = Math::FloorToInt(chunkCoordinate);
+
+        if (coordinate < 0)
+            return 0;
+
+        if (coordinate >= static_cast<i32>(MAP_CHUNKS_PER_MAP_STRIDE))
+            return MAP_CHUNKS_PER_MAP_STRIDE - 1;
+
+        return static_cast<u16>(coordinate);
+    }
+
+    void Map::UpdateEntityChunk(entt::entity entity, const vec3& position)
+    {
+        u16 chunkID = GetChunkIDFromWorldPosition(position);
+
+        auto itr = entityToChunkID.find(entity);
+        if (itr != entityToChunkID.end())
+        {
+            // Still in the same chunk, nothing to do
+            if (itr->second == chunkID)
+                return;
+
+            RemoveEntityChunk(entity);
+        }
+
+        chunksEntityList[chunkID].PushBack(entity);
+        entityToChunkID[entity] = chunkID;
+    }
+
+    void Map::RemoveEntityChunk(entt::entity entity)
+    {
+        auto itr = entityToChunkID.find(entity);
+        if (itr == entityToChunkID.end())
+            return;
+
+        SafeVector<entt::entity>* entityList = GetEntityListByChunkID(itr->second);
+        if (entityList)
+        {
+            entityList->WriteLock([entity](std::vector<entt::entity>& entities)
+            {
+                auto entityItr = std::find(entities.begin(), entities.end(), entity);
+                if (entityItr == entities.end())
+                    return;
+
+                // Order within a chunk doesn't matter
+                *entityItr = entities.back();
+                entities.pop_back();
+            });
+        }
+
+        entityToChunkID.erase(itr);
+    }
+
+    void Map::GetEntitiesInChunksWithinDistance(const vec3& position, f32 radius, std::vector<entt::entity>& results)
+    {
+        ForEachChunkWithinDistance(position, radius, [&results](u16 /*chunkID*/, const std::vector<entt::entity>& entities)
+        {
+            results.insert(results.end(), entities.begin(), entities.end());
+        });
+    }
+
     void Map::GetChunkPositionFromChunkId(u16 chunkId, u16& x, u16& y) const
     {
         x = chunkId % MAP_CHUNKS_PER_MAP_STRIDE;
@@ -24,4 +88,20 @@ namespace Terrain
     {
         return Math::FloorToInt(chunkPos.x) + (Math::FloorToInt(chunkPos.y) * Terrain::MAP_CHUNKS_PER_MAP_STRIDE);
     }
+    u16 Map::GetChunkIDFromWorldPosition(const vec3& position)
+    {
+        vec2 chunkPos = GetChunkFromAdtPosition(WorldPositionToADTCoordinates(position));
+        return static_cast<u16>(ClampChunkCoordinate(chunkPos.x) + (ClampChunkCoordinate(chunkPos.y) * MAP_CHUNKS_PER_MAP_STRIDE));
+    }
+    void Map::GetChunkRangeWithinDistance(const vec3& position, f32 radius, u16& minX, u16& maxX, u16& minY, u16& maxY)
+    {
+        // The ADT axes are flipped compared to the world axes, so the corners have to be sorted again
+        vec2 cornerA = GetChunkFromAdtPosition(WorldPositionToADTCoordinates(vec3(position.x - radius, position.y - radius, 0.0f)));
+        vec2 cornerB = GetChunkFromAdtPosition(WorldPositionToADTCoordinates(vec3(position.x + radius, position.y + radius, 0.0f)));
+
+        minX = ClampChunkCoordinate(std::min(cornerA.x, cornerB.x));
+        maxX = ClampChunkCoordinate(std::max(cornerA.x, cornerB.x));
+        minY = ClampChunkCoordinate(std::min(cornerA.y, cornerB.y));
+        maxY = ClampChunkCoordinate(std::max(cornerA.y, cornerB.y));
+    }
 }
\ No newline at end of file
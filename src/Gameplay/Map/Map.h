@@ -26,6 +26,7 @@
 #include <robin_hood.h>
 #include <entity/fwd.hpp>
 #include <limits>
+#include <vector>
 #include <Containers/StringTable.h>
 #include <Utils/SafeVector.h>
 
@@ -53,6 +54,7 @@ namespace Terrain
         u16 id = std::numeric_limits<u16>().max(); // Default Map to Invalid ID
         std::string_view name;
         robin_hood::unordered_map<u16, SafeVector<entt::entity>> chunksEntityList;
+        robin_hood::unordered_map<entt::entity, u16> entityToChunkID;
 
         bool IsMapLoaded(u16 newId) { return id == newId; }
 
@@ -65,10 +67,44 @@ namespace Terrain
             return &itr->second;
         }
 
+        // Moves the entity to the chunk containing position, the chunk lists are only touched when the chunk ID changes
+        void UpdateEntityChunk(entt::entity entity, const vec3& position);
+        void RemoveEntityChunk(entt::entity entity);
+
+        // Coarse query, returns every entity in the chunks overlapping the radius (entities may be further away than radius)
+        void GetEntitiesInChunksWithinDistance(const vec3& position, f32 radius, std::vector<entt::entity>& results);
+
+        // Calls func(chunkID, entities) for every non empty chunk overlapping the radius
+        template <typename Func>
+        void ForEachChunkWithinDistance(const vec3& position, f32 radius, Func&& func)
+        {
+            u16 minX, maxX, minY, maxY;
+            GetChunkRangeWithinDistance(position, radius, minX, maxX, minY, maxY);
+
+            for (u16 y = minY; y <= maxY; y++)
+            {
+                for (u16 x = minX; x <= maxX; x++)
+                {
+                    u16 chunkID = static_cast<u16>(x + (y * MAP_CHUNKS_PER_MAP_STRIDE));
+
+                    SafeVector<entt::entity>* entityList = GetEntityListByChunkID(chunkID);
+                    if (entityList == nullptr || entityList->Size() == 0)
+                        continue;
+
+                    entityList->ReadLock([&func, chunkID](const std::vector<entt::entity>& entities)
+                    {
+                        func(chunkID, entities);
+                    });
+                }
+            }
+        }
+
         void GetChunkPositionFromChunkId(u16 chunkId, u16& x, u16& y) const;
         static vec2 WorldPositionToADTCoordinates(const vec3& position);
         static vec2 GetChunkFromAdtPosition(const vec2& adtPosition);
         static u32 GetChunkIDFromChunkPos(const vec2& chunkPos);
+        static u16 GetChunkIDFromWorldPosition(const vec3& position);
+        static void GetChunkRangeWithinDistance(const vec3& position, f32 radius, u16& minX, u16& maxX, u16& minY, u16& maxY);
 
         void Clear()
         {
@@ -80,6 +116,7 @@ namespace Terrain
                 pair.second.Clear();
             }
             chunksEntityList.clear();
+            entityToChunkID.clear();
         }
     };
 }
\ No newline at end of file
@@ -0,0 +1,239 @@
+#include "SpatialGrid.h"
+
+#if defined(__AVX2__)
+#define SPATIAL_GRID_AVX2 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SPATIAL_GRID_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// Writes the index and squared distance of every position within distance, returns the number of matches
+static size_t FilterWithinDistance(const f32* x, const f32* y, size_t count, f32 positionX, f32 positionY, f32 distanceSquared, u32* outIndices, f32* outDistancesSquared)
+{
+    size_t numMatches = 0;
+    size_t i = 0;
+
+#if SPATIAL_GRID_AVX2
+    const __m256 positionX8 = _mm256_set1_ps(positionX);
+    const __m256 positionY8 = _mm256_set1_ps(positionY);
+    const __m256 distanceSquared8 = _mm256_set1_ps(distanceSquared);
+    alignas(32) f32 lanes[8];
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 deltaX = _mm256_sub_ps(_mm256_loadu_ps(x + i), positionX8);
+        __m256 deltaY = _mm256_sub_ps(_mm256_loadu_ps(y + i), positionY8);
+        __m256 lengthSquared = _mm256_add_ps(_mm256_mul_ps(deltaX, deltaX), _mm256_mul_ps(deltaY, deltaY));
+
+        i32 mask = _mm256_movemask_ps(_mm256_cmp_ps(lengthSquared, distanceSquared8, _CMP_LE_OQ));
+        if (mask == 0)
+            continue;
+
+        _mm256_store_ps(lanes, lengthSquared);
+        for (u32 lane = 0; lane < 8; lane++)
+        {
+            if (mask & (1 << lane))
+            {
+                outIndices[numMatches] = static_cast<u32>(i + lane);
+                outDistancesSquared[numMatches] = lanes[lane];
+                numMatches++;
+            }
+        }
+    }
+#elif SPATIAL_GRID_SSE2
+    const __m128 positionX4 = _mm_set1_ps(positionX);
+    const __m128 positionY4 = _mm_set1_ps(positionY);
+    const __m128 distanceSquared4 = _mm_set1_ps(distanceSquared);
+    alignas(16) f32 lanes[4];
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 deltaX = _mm_sub_ps(_mm_loadu_ps(x + i), positionX4);
+        __m128 deltaY = _mm_sub_ps(_mm_loadu_ps(y + i), positionY4);
+        __m128 lengthSquared = _mm_add_ps(_mm_mul_ps(deltaX, deltaX), _mm_mul_ps(deltaY, deltaY));
+
+        i32 mask = _mm_movemask_ps(_mm_cmple_ps(lengthSquared, distanceSquared4));
+        if (mask == 0)
+            continue;
+
+        _mm_store_ps(lanes, lengthSquared);
+        for (u32 lane = 0; lane < 4; lane++)
+        {
+            if (mask & (1 << lane))
+            {
+                outIndices[numMatches] = static_cast<u32>(i + lane);
+                outDistancesSquared[numMatches] = lanes[lane];
+                numMatches++;
+            }
+        }
+    }
+#endif
+
+    // Scalar fallback, also handles the tail that doesn't fill a whole register
+    for (; i < count; i++)
+    {
+        f32 deltaX = x[i] - positionX;
+        f32 deltaY = y[i] - positionY;
+        f32 lengthSquared = (deltaX * deltaX) + (deltaY * deltaY);
+
+        if (lengthSquared <= distanceSquared)
+        {
+            outIndices[numMatches] = static_cast<u32>(i);
+            outDistancesSquared[numMatches] = lengthSquared;
+            numMatches++;
+        }
+    }
+
+    return numMatches;
+}
+
+SpatialGrid::SpatialGrid() : _cells(CELLS_PER_MAP) { }
+
+void SpatialGrid::Update(entt::entity entity, const vec2& position)
+{
+    u32 cellIndex = GetCellIndex(position);
+
+    auto itr = _locations.find(entity);
+    if (itr != _locations.end())
+    {
+        Location& location = itr->second;
+
+        // Same cell, only the stored position needs to change
+        if (location.cellIndex == cellIndex)
+        {
+            Cell& cell = _cells[cellIndex];
+            cell.x[location.slot] = position.x;
+            cell.y[location.slot] = position.y;
+            return;
+        }
+
+        RemoveFromCell(location);
+    }
+
+    Cell& cell = _cells[cellIndex];
+    u32 slot = static_cast<u32>(cell.entities.size());
+
+    cell.x.push_back(position.x);
+    cell.y.push_back(position.y);
+    cell.entities.push_back(entity);
+
+    _locations[entity] = { cellIndex, slot };
+}
+
+void SpatialGrid::Remove(entt::entity entity)
+{
+    auto itr = _locations.find(entity);
+    if (itr == _locations.end())
+        return;
+
+    RemoveFromCell(itr->second);
+    _locations.erase(itr);
+}
+
+void SpatialGrid::Clear()
+{
+    for (Cell& cell : _cells)
+    {
+        cell.x.clear();
+        cell.y.clear();
+        cell.entities.clear();
+    }
+
+    _locations.clear();
+}
+
+void SpatialGrid::GetWithinDistance(const vec2& position, f32 distance, entt::entity exclude, std::vector<entt::entity>& results) const
+{
+    ForEachWithinDistance(position, distance, [&results, exclude](entt::entity entity, f32 /*distanceSquared*/)
+    {
+        if (entity != exclude)
+            results.push_back(entity);
+    });
+}
+
+void SpatialGrid::GetWithinDistance(const vec2* positions, size_t numPositions, f32 distance, RadiusQueryResults& results) const
+{
+    results.Clear();
+    results.offsets.reserve(numPositions + 1);
+    results.offsets.push_back(0);
+
+    f32 distanceSquared = distance * distance;
+
+    // Scratch space for a single cell, reused for the whole batch
+    std::vector<u32> matchIndices;
+    std::vector<f32> matchDistancesSquared;
+
+    for (size_t query = 0; query < numPositions; query++)
+    {
+        const vec2& position = positions[query];
+
+        i32 minX = ToCellCoordinate(position.x - distance);
+        i32 maxX = ToCellCoordinate(position.x + distance);
+        i32 minY = ToCellCoordinate(position.y - distance);
+        i32 maxY = ToCellCoordinate(position.y + distance);
+
+        for (i32 y = minY; y <= maxY; y++)
+        {
+            for (i32 x = minX; x <= maxX; x++)
+            {
+                const Cell& cell = _cells[GetCellIndex(x, y)];
+
+                size_t numEntities = cell.entities.size();
+                if (numEntities == 0)
+                    continue;
+
+                if (matchIndices.size() < numEntities)
+                {
+                    matchIndices.resize(numEntities);
+                    matchDistancesSquared.resize(numEntities);
+                }
+
+                size_t numMatches = FilterWithinDistance(cell.x.data(), cell.y.data(), numEntities, position.x, position.y, distanceSquared, matchIndices.data(), matchDistancesSquared.data());
+                for (size_t i = 0; i < numMatches; i++)
+                {
+                    results.entities.push_back(cell.entities[matchIndices[i]]);
+                    results.distancesSquared.push_back(matchDistancesSquared[i]);
+                }
+            }
+        }
+
+        results.offsets.push_back(static_cast<u32>(results.entities.size()));
+    }
+}
+
+i32 SpatialGrid::ToCellCoordinate(f32 value)
+{
+    // Remap [-MAP_HALF_SIZE .. MAP_HALF_SIZE] to [0 .. CELLS_PER_MAP_STRIDE - 1], anything outside of the map is clamped to the border cells
+    i32 coordinate = Math::FloorToInt((value + Terrain::MAP_HALF_SIZE) / CELL_SIZE);
+
+    if (coordinate < 0)
+        return 0;
+
+    if (coordinate >= static_cast<i32>(CELLS_PER_MAP_STRIDE))
+        return CELLS_PER_MAP_STRIDE - 1;
+
+    return coordinate;
+}
+
+void SpatialGrid::RemoveFromCell(const Location& location)
+{
+    Cell& cell = _cells[location.cellIndex];
+    u32 lastSlot = static_cast<u32>(cell.entities.size()) - 1;
+
+    // Swap with the last entry so removal stays O(1), the moved entity needs its slot patched
+    if (location.slot != lastSlot)
+    {
+        entt::entity movedEntity = cell.entities[lastSlot];
+
+        cell.x[location.slot] = cell.x[lastSlot];
+        cell.y[location.slot] = cell.y[lastSlot];
+        cell.entities[location.slot] = movedEntity;
+
+        _locations[movedEntity].slot = location.slot;
+    }
+
+    cell.x.pop_back();
+    cell.y.pop_back();
+    cell.entities.pop_back();
+}
\ No newline at end of file
@@ -0,0 +1,132 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <NovusTypes.h>
+#include <robin_hood.h>
+#include <entity/fwd.hpp>
+#include <vector>
+#include "Map.h"
+
+// Results of a batched radius query, the results of query i are stored at [offsets[i] .. offsets[i + 1])
+struct RadiusQueryResults
+{
+    std::vector<entt::entity> entities;
+    std::vector<f32> distancesSquared;
+    std::vector<u32> offsets;
+
+    void Clear()
+    {
+        entities.clear();
+        distancesSquared.clear();
+        offsets.clear();
+    }
+
+    size_t GetNumQueries() const { return offsets.size() > 0 ? offsets.size() - 1 : 0; }
+    u32 GetNumResults(size_t query) const { return offsets[query + 1] - offsets[query]; }
+    const entt::entity* GetEntities(size_t query) const { return entities.data() + offsets[query]; }
+    const f32* GetDistancesSquared(size_t query) const { return distancesSquared.data() + offsets[query]; }
+};
+
+// A uniform grid over the whole map, entities are only moved between cells when their position is updated.
+// Positions are stored per cell as separate X / Y arrays so range queries walk contiguous memory.
+class SpatialGrid
+{
+public:
+    static constexpr u32 CELLS_PER_CHUNK_STRIDE = 4;
+    static constexpr u32 CELLS_PER_MAP_STRIDE = Terrain::MAP_CHUNKS_PER_MAP_STRIDE * CELLS_PER_CHUNK_STRIDE;
+    static constexpr u32 CELLS_PER_MAP = CELLS_PER_MAP_STRIDE * CELLS_PER_MAP_STRIDE;
+    static constexpr f32 CELL_SIZE = Terrain::MAP_CHUNK_SIZE / CELLS_PER_CHUNK_STRIDE; // yards
+
+    SpatialGrid();
+
+    // Inserts the entity if it is not in the grid yet, otherwise moves it
+    void Update(entt::entity entity, const vec2& position);
+    void Remove(entt::entity entity);
+    void Clear();
+
+    bool Contains(entt::entity entity) const { return _locations.find(entity) != _locations.end(); }
+    size_t Size() const { return _locations.size(); }
+
+    void GetWithinDistance(const vec2& position, f32 distance, entt::entity exclude, std::vector<entt::entity>& results) const;
+
+    // Runs one radius query per position, results are appended to the (cleared) results without any per query allocations
+    void GetWithinDistance(const vec2* positions, size_t numPositions, f32 distance, RadiusQueryResults& results) const;
+
+    // Calls func(entity, distanceSquared) for every entity within distance of position
+    template <typename Func>
+    void ForEachWithinDistance(const vec2& position, f32 distance, Func&& func) const
+    {
+        i32 minX = ToCellCoordinate(position.x - distance);
+        i32 maxX = ToCellCoordinate(position.x + distance);
+        i32 minY = ToCellCoordinate(position.y - distance);
+        i32 maxY = ToCellCoordinate(position.y + distance);
+
+        f32 distanceSquared = distance * distance;
+
+        for (i32 y = minY; y <= maxY; y++)
+        {
+            for (i32 x = minX; x <= maxX; x++)
+            {
+                const Cell& cell = _cells[GetCellIndex(x, y)];
+
+                size_t numEntities = cell.entities.size();
+                for (size_t i = 0; i < numEntities; i++)
+                {
+                    f32 deltaX = cell.x[i] - position.x;
+                    f32 deltaY = cell.y[i] - position.y;
+                    f32 entityDistanceSquared = (deltaX * deltaX) + (deltaY * deltaY);
+
+                    if (entityDistanceSquared <= distanceSquared)
+                    {
+                        func(cell.entities[i], entityDistanceSquared);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    struct Cell
+    {
+        std::vector<f32> x;
+        std::vector<f32> y;
+        std::vector<entt::entity> entities;
+    };
+
+    struct Location
+    {
+        u32 cellIndex;
+        u32 slot;
+    };
+
+    static i32 ToCellCoordinate(f32 value);
+    static u32 GetCellIndex(i32 x, i32 y) { return static_cast<u32>(x) + (static_cast<u32>(y) * CELLS_PER_MAP_STRIDE); }
+    static u32 GetCellIndex(const vec2& position) { return GetCellIndex(ToCellCoordinate(position.x), ToCellCoordinate(position.y)); }
+
+    void RemoveFromCell(const Location& location);
+
+private:
+    std::vector<Cell> _cells;
+    robin_hood::unordered_map<entt::entity, Location> _locations;
+};
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "AccountCache.h"
+#include <algorithm>
+#include <cctype>
+
+void AccountCache::SetEnabled(bool isEnabled)
+{
+    if (!isEnabled)
+    {
+        Clear();
+    }
+
+    _isEnabled = isEnabled;
+}
+
+const AccountCache::Entry* AccountCache::Get(const std::string& username, f32 time)
+{
+    if (!_isEnabled)
+    {
+        _numMisses++;
+        return nullptr;
+    }
+
+    auto itr = _entries.find(GetKey(username));
+    if (itr == _entries.end())
+    {
+        _numMisses++;
+        return nullptr;
+    }
+
+    if (itr->second.expireTime <= time)
+    {
+        _entries.erase(itr);
+        _numMisses++;
+        return nullptr;
+    }
+
+    _numHits++;
+    return &itr->second;
+}
+
+AccountCache::Entry& AccountCache::Insert(const std::string& username, f32 time)
+{
+    std::string key = GetKey(username);
+
+    // Logging in again only refreshes the entry, it shouldn't push anything else out
+    auto itr = _entries.find(key);
+    if (itr == _entries.end())
+    {
+        while (_entries.size() >= ACCOUNT_CACHE_MAX_ENTRIES && !_insertOrder.empty())
+        {
+            const InsertRecord& record = _insertOrder.front();
+
+            auto oldest = _entries.find(record.key);
+            if (oldest != _entries.end() && oldest->second.insertIndex == record.insertIndex)
+            {
+                _entries.erase(oldest);
+                _numEvictions++;
+            }
+
+            _insertOrder.pop_front();
+        }
+
+        itr = _entries.emplace(key, Entry()).first;
+    }
+
+    // Stale records pile up when the same accounts keep logging in, drop them before they outgrow the cache
+    if (_insertOrder.size() >= ACCOUNT_CACHE_MAX_ENTRIES * 2)
+    {
+        _insertOrder.erase(std::remove_if(_insertOrder.begin(), _insertOrder.end(), [this](const InsertRecord& record)
+        {
+            auto entry = _entries.find(record.key);
+            return entry == _entries.end() || entry->second.insertIndex != record.insertIndex;
+        }), _insertOrder.end());
+    }
+
+    Entry& entry = itr->second;
+    entry.expireTime = time + ACCOUNT_CACHE_TTL;
+    entry.insertIndex = _numInserts++;
+
+    _insertOrder.push_back({ std::move(key), entry.insertIndex });
+    return entry;
+}
+
+bool AccountCache::Invalidate(const std::string& username)
+{
+    _generation++;
+
+    if (_entries.erase(GetKey(username)) == 0)
+        return false;
+
+    _numInvalidations++;
+    return true;
+}
+
+void AccountCache::Clear()
+{
+    _generation++;
+    _numInvalidations += _entries.size();
+
+    _entries.clear();
+    _insertOrder.clear();
+}
+
+std::string AccountCache::GetKey(const std::string& username)
+{
+    std::string key = username;
+    std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+
+    return key;
+}
\ No newline at end of file
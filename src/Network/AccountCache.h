@@ -0,0 +1,74 @@
+#pragma once
+#include <NovusTypes.h>
+#include <robin_hood.h>
+#include <deque>
+#include <string>
+
+#define ACCOUNT_CACHE_SALT_SIZE 4
+#define ACCOUNT_CACHE_VERIFIER_SIZE 256
+
+// Long enough to cover a world restart or a network blip, short enough that a password changed behind our back doesn't stick around for long
+#define ACCOUNT_CACHE_TTL 300.0f
+#define ACCOUNT_CACHE_MAX_ENTRIES 16384
+
+// Decoded salt and verifier of recent logins, so reconnects don't need the accounts table
+// Only ever touched by the tick, usernames are matched case insensitively like the accounts table does
+// The auth server tells us about password changes over the internal link (SMSG_ACCOUNT_CHANGED), so the cache is only enabled while that link is up
+// It stays disabled unless the world server is built with WORLD_ENABLE_ACCOUNT_CACHE, see InternalOpcodes.h
+class AccountCache
+{
+public:
+    struct Entry
+    {
+        u8 salt[ACCOUNT_CACHE_SALT_SIZE];
+        u8 verifier[ACCOUNT_CACHE_VERIFIER_SIZE];
+        f32 expireTime = 0.0f;
+        u64 insertIndex = 0;
+    };
+
+    // Disabling drops every entry, nothing is cached while we can't hear about password changes
+    void SetEnabled(bool isEnabled);
+    bool IsEnabled() const { return _isEnabled; }
+
+    // Nullptr on a miss (always while disabled), expired entries are dropped here
+    const Entry* Get(const std::string& username, f32 time);
+
+    // Evicts the oldest entries when full, callers only insert while enabled
+    Entry& Insert(const std::string& username, f32 time);
+
+    // When a password changes, returns false if it wasn't cached
+    bool Invalidate(const std::string& username);
+    void Clear();
+
+    // Bumped by every invalidation, a lookup that started before one may have read the old password and must not be inserted
+    u64 GetGeneration() const { return _generation; }
+
+    size_t GetNumEntries() const { return _entries.size(); }
+    u64 GetNumHits() const { return _numHits; }
+    u64 GetNumMisses() const { return _numMisses; }
+    u64 GetNumInvalidations() const { return _numInvalidations; }
+    u64 GetNumEvictions() const { return _numEvictions; }
+
+private:
+    static std::string GetKey(const std::string& username);
+
+private:
+    robin_hood::unordered_map<std::string, Entry> _entries;
+
+    // Insertion order for eviction, entries that were invalidated or inserted again since leave a stale record behind that is skipped
+    struct InsertRecord
+    {
+        std::string key;
+        u64 insertIndex;
+    };
+    std::deque<InsertRecord> _insertOrder;
+
+    bool _isEnabled = false;
+    u64 _generation = 0;
+    u64 _numInserts = 0;
+
+    u64 _numHits = 0;
+    u64 _numMisses = 0;
+    u64 _numInvalidations = 0;
+    u64 _numEvictions = 0;
+};
\ No newline at end of file
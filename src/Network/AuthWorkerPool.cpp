@@ -0,0 +1,81 @@
+#include "AuthWorkerPool.h"
+#include <tracy/Tracy.hpp>
+#include <chrono>
+
+void AuthWorkerPool::Start(u32 numWorkers)
+{
+    {
+        std::lock_guard<std::mutex> lock(_jobMutex);
+        _isRunning = true;
+    }
+
+    for (u32 i = 0; i < numWorkers; i++)
+    {
+        _threads.emplace_back(&AuthWorkerPool::Run, this);
+    }
+}
+
+void AuthWorkerPool::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_jobMutex);
+        _isRunning = false;
+    }
+
+    _jobCondition.notify_all();
+
+    for (std::thread& thread : _threads)
+    {
+        thread.join();
+    }
+
+    _threads.clear();
+}
+
+void AuthWorkerPool::Enqueue(AuthJob job)
+{
+    _numPending++;
+
+    {
+        std::lock_guard<std::mutex> lock(_jobMutex);
+        _jobs.push_back(std::move(job));
+    }
+
+    _jobCondition.notify_one();
+}
+
+void AuthWorkerPool::Run()
+{
+    tracy::SetThreadName("AuthWorker");
+
+    while (true)
+    {
+        AuthJob job;
+        {
+            std::unique_lock<std::mutex> lock(_jobMutex);
+            _jobCondition.wait(lock, [this]() { return !_jobs.empty() || !_isRunning; });
+
+            // Only stops once everything queued is done
+            if (_jobs.empty())
+                break;
+
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+        }
+
+        ZoneScopedNC("AuthWorkerPool::Run", tracy::Color::Orange);
+
+        auto start = std::chrono::steady_clock::now();
+        AuthCompletion completion = job();
+        auto end = std::chrono::steady_clock::now();
+
+        if (completion)
+        {
+            _completions.enqueue(std::move(completion));
+        }
+
+        _jobTimeUS += static_cast<u64>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+        _numCompleted++;
+        _numPending--;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+#include <NovusTypes.h>
+#include <Utils/ConcurrentQueue.h>
+#include <entity/fwd.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// SRP-6a is a handful of big number modular exponentiations per login, a login wave would otherwise land straight on the tick
+#ifndef AUTH_WORKER_COUNT
+#define AUTH_WORKER_COUNT 2
+#endif
+
+// Applied to the registry on the tick by AuthCompletionSystem
+using AuthCompletion = std::function<void(entt::registry&)>;
+
+// Runs on a worker, must only touch what it captured
+using AuthJob = std::function<AuthCompletion()>;
+
+// Runs the SRP math of client logins off the tick, the connection stays in its auth status until the completion is applied
+class AuthWorkerPool
+{
+public:
+    AuthWorkerPool() : _completions(256) { }
+    ~AuthWorkerPool() { Stop(); }
+
+    AuthWorkerPool(const AuthWorkerPool&) = delete;
+    AuthWorkerPool& operator=(const AuthWorkerPool&) = delete;
+
+    void Start(u32 numWorkers);
+
+    // Finishes every job already queued before returning
+    void Stop();
+
+    void Enqueue(AuthJob job);
+    bool TryGetCompletion(AuthCompletion& completion) { return _completions.try_dequeue(completion); }
+
+    size_t GetNumPending() const { return _numPending; }
+    u64 GetNumCompleted() const { return _numCompleted; }
+
+    // Time spent running jobs summed over every worker
+    u64 GetJobTimeUS() const { return _jobTimeUS; }
+
+private:
+    void Run();
+
+private:
+    std::vector<std::thread> _threads;
+
+    std::mutex _jobMutex;
+    std::condition_variable _jobCondition;
+    std::deque<AuthJob> _jobs;
+    bool _isRunning = false;
+
+    moodycamel::ConcurrentQueue<AuthCompletion> _completions;
+
+    std::atomic<size_t> _numPending = { 0 };
+    std::atomic<u64> _numCompleted = { 0 };
+    std::atomic<u64> _jobTimeUS = { 0 };
+};
\ No newline at end of file
@@ -4,7 +4,6 @@
 #include <Networking/NetStructures.h>
 #include <Networking/NetPacket.h>
 #include <Networking/NetClient.h>
-#include <Networking/NetPacketHandler.h>
 #include <Networking/PacketUtils.h>
 #include <Utils/ByteBuffer.h>
 #include <Utils/StringUtils.h>
@@ -14,109 +13,209 @@
 #include "../../../../ECS/Components/Network/AuthenticationSingleton.h"
 #include "../../../../ECS/Components/Network/ConnectionDeferredSingleton.h"
 #include "../../../../ECS/Components/Network/Authentication.h"
+#include "../../../../ECS/Components/Network/ConnectionComponent.h"
+#include "../../../../ECS/Components/Singletons/TimeSingleton.h"
 
 // @TODO: Remove Temporary Includes when they're no longer needed
 #include <Utils/DebugHandler.h>
 
 namespace Client
 {
-    void AuthHandlers::Setup(NetPacketHandler* netPacketHandler)
+    bool AuthHandlers::HandshakeHandler(NetClient& netClient, DeserializedPayload<ClientLogonChallenge>& payload)
     {
-        u16 authChallengeMinSize = static_cast<u16>(sizeof(u8) * 4 + sizeof(u16) + 4 + 256);
-        i16 authChallengeMaxSize = authChallengeMinSize + 33;
-        netPacketHandler->SetMessageHandler(Opcode::CMSG_LOGON_CHALLENGE, { ConnectionStatus::AUTH_CHALLENGE, authChallengeMinSize, authChallengeMaxSize, AuthHandlers::HandshakeHandler });
-        netPacketHandler->SetMessageHandler(Opcode::CMSG_LOGON_HANDSHAKE, { ConnectionStatus::AUTH_HANDSHAKE, sizeof(ClientLogonHandshake), AuthHandlers::HandshakeResponseHandler });
-    }
-
-    bool AuthHandlers::HandshakeHandler(std::shared_ptr<NetClient> netClient, std::shared_ptr<NetPacket> packet)
-    {
-        ClientLogonChallenge logonChallenge;
-        logonChallenge.Deserialize(packet->payload);
+        ClientLogonChallenge& logonChallenge = payload.value;
 
         entt::registry* registry = ServiceLocator::GetRegistry();
-        Authentication& authentication = registry->get<Authentication>(netClient->GetEntity());
+        entt::entity entity = netClient.GetEntity();
+
+        // Only one challenge per connection
+        Authentication& authentication = registry->get<Authentication>(entity);
+        if (authentication.isChallengePending)
+            return false;
+
         authentication.username = logonChallenge.username;
+        authentication.isChallengePending = true;
+
+        // Reconnecting accounts skip the database entirely, as long as the auth server can tell us about password changes
+        AuthenticationSingleton& authenticationSingleton = registry->ctx<AuthenticationSingleton>();
+        AccountCache& accountCache = authenticationSingleton.accountCache;
 
-        std::shared_ptr<Bytebuffer> sBuffer = Bytebuffer::Borrow<4>();
-        std::shared_ptr<Bytebuffer> vBuffer = Bytebuffer::Borrow<256>();
+        f32 time = registry->ctx<TimeSingleton>().lifeTimeInS;
+        if (const AccountCache::Entry* account = accountCache.Get(authentication.username, time))
+        {
+            QueueVerification(*registry, entity, authentication, logonChallenge, *account);
+            return true;
+        }
 
         DBSingleton& dbSingleton = registry->ctx<DBSingleton>();
 
-        std::stringstream ss;
-        ss << "SELECT salt, verifier FROM accounts WHERE username='" << authentication.username << "';";
+        // The username comes straight from the client, it is only ever bound as a value
+        DBPreparedStatement statement("SELECT salt, verifier FROM accounts WHERE username=?;");
+        statement.Bind(authentication.username);
 
-        std::shared_ptr<QueryResult> result = dbSingleton.auth.Query(ss.str());
+        // The challenge is answered once the account is found, a few ticks later
+        dbSingleton.workers.Query(std::move(statement), [entity, logonChallenge, generation = accountCache.GetGeneration()](entt::registry& registry, std::shared_ptr<QueryResult> result)
+        {
+            HandleAccountResult(registry, entity, logonChallenge, generation, result);
+        });
+
+        return true;
+    }
+    void AuthHandlers::HandleAccountResult(entt::registry& registry, entt::entity entity, const ClientLogonChallenge& logonChallenge, u64 generation, std::shared_ptr<QueryResult> result)
+    {
+        ConnectionComponent* connection = GetConnection(registry, entity);
+        if (!connection)
+            return;
+
+        Authentication& authentication = registry.get<Authentication>(entity);
+        AuthenticationSingleton& authenticationSingleton = registry.ctx<AuthenticationSingleton>();
 
         // If we found no account with the provided username we "temporarily" close the connection
         // TODO: Generate Random Salt & Verifier (Shorter length?) and "fake" logon challenge to not give away if an account exists or not
-        if (result->GetAffectedRows() == 0)
+        if (!result || result->GetAffectedRows() == 0)
         {
+            authenticationSingleton.numFailedLogins++;
             DebugHandler::PrintWarning("Unsuccessful Login for: %s", authentication.username.c_str());
-            netClient->Close();
-            return true;
+            connection->channel->Close();
+            return;
         }
 
+        AccountCache::Entry decodedAccount;
+
+        // The password changed while we were waiting on the database, this result may be from before that so it isn't kept around
+        AccountCache& accountCache = authenticationSingleton.accountCache;
+        bool isCacheable = accountCache.IsEnabled() && generation == accountCache.GetGeneration();
+
+        f32 time = registry.ctx<TimeSingleton>().lifeTimeInS;
+        AccountCache::Entry& account = isCacheable ? accountCache.Insert(authentication.username, time) : decodedAccount;
+
         result->GetNextRow();
         {
             const Field& saltField = result->GetField(0);
             const Field& verifierField = result->GetField(1);
 
             std::string salt = saltField.GetString();
-            StringUtils::HexStrToBytes(salt.c_str(), sBuffer->GetDataPointer());
+            StringUtils::HexStrToBytes(salt.c_str(), account.salt);
 
             std::string verifier = verifierField.GetString();
-            StringUtils::HexStrToBytes(verifier.c_str(), vBuffer->GetDataPointer());
+            StringUtils::HexStrToBytes(verifier.c_str(), account.verifier);
         }
 
-        authentication.srp.saltBuffer = sBuffer;
-        authentication.srp.verifierBuffer = vBuffer;
+        QueueVerification(registry, entity, authentication, logonChallenge, account);
+    }
+    void AuthHandlers::QueueVerification(entt::registry& registry, entt::entity entity, Authentication& authentication, const ClientLogonChallenge& logonChallenge, const AccountCache::Entry& account)
+    {
+        std::shared_ptr<Bytebuffer> sBuffer = Bytebuffer::Borrow<ACCOUNT_CACHE_SALT_SIZE>();
+        std::shared_ptr<Bytebuffer> vBuffer = Bytebuffer::Borrow<ACCOUNT_CACHE_VERIFIER_SIZE>();
+        std::memcpy(sBuffer->GetDataPointer(), account.salt, sizeof(account.salt));
+        std::memcpy(vBuffer->GetDataPointer(), account.verifier, sizeof(account.verifier));
+
+        std::shared_ptr<SRPVerifier> srp = authentication.srp;
+        srp->saltBuffer = sBuffer;
+        srp->verifierBuffer = vBuffer;
+
+        // Generating B is the expensive part, the challenge is answered once a worker is done with it
+        AuthenticationSingleton& authenticationSingleton = registry.ctx<AuthenticationSingleton>();
+        authenticationSingleton.workers.Enqueue([entity, srp, username = authentication.username, logonChallenge]() mutable -> AuthCompletion
+        {
+            bool didStart = srp->StartVerification(username, logonChallenge.A);
+
+            return [entity, didStart](entt::registry& registry)
+            {
+                HandleChallengeResult(registry, entity, didStart);
+            };
+        });
+    }
+    void AuthHandlers::HandleChallengeResult(entt::registry& registry, entt::entity entity, bool didStart)
+    {
+        ConnectionComponent* connection = GetConnection(registry, entity);
+        if (!connection)
+            return;
+
+        NetClient& netClient = *connection->netClient;
+        Authentication& authentication = registry.get<Authentication>(entity);
+        authentication.isChallengePending = false;
 
         // If "StartVerification" fails, we have either hit a bad memory allocation or a SRP-6a safety check, thus we should close the connection
-        if (!authentication.srp.StartVerification(authentication.username, logonChallenge.A))
+        if (!didStart)
         {
+            registry.ctx<AuthenticationSingleton>().numFailedLogins++;
             DebugHandler::PrintWarning("Unsuccessful Login for: %s", authentication.username.c_str());
-            netClient->Close();
-            return true;
+            connection->channel->Close();
+            return;
         }
 
+        SRPVerifier& srp = *authentication.srp;
+
         std::shared_ptr<Bytebuffer> buffer = Bytebuffer::Borrow<512>();
         ServerLogonChallenge serverChallenge;
         serverChallenge.status = 0;
 
-        std::memcpy(serverChallenge.s, authentication.srp.saltBuffer->GetDataPointer(), authentication.srp.saltBuffer->size);
-        std::memcpy(serverChallenge.B, authentication.srp.bBuffer->GetDataPointer(), authentication.srp.bBuffer->size);
+        std::memcpy(serverChallenge.s, srp.saltBuffer->GetDataPointer(), srp.saltBuffer->size);
+        std::memcpy(serverChallenge.B, srp.bBuffer->GetDataPointer(), srp.bBuffer->size);
 
         buffer->Put(Opcode::SMSG_LOGON_CHALLENGE);
         buffer->PutU16(0);
 
         u16 payloadSize = serverChallenge.Serialize(buffer);
         buffer->Put<u16>(payloadSize, 2);
-        netClient->Send(buffer);
+        connection->AddPacket(buffer, PacketPriority::IMMEDIATE);
 
-        netClient->SetConnectionStatus(ConnectionStatus::AUTH_HANDSHAKE);
-        return true;
+        netClient.SetConnectionStatus(ConnectionStatus::AUTH_HANDSHAKE);
     }
-    bool AuthHandlers::HandshakeResponseHandler(std::shared_ptr<NetClient> netClient, std::shared_ptr<NetPacket> packet)
+    bool AuthHandlers::HandshakeResponseHandler(NetClient& netClient, DeserializedPayload<ClientLogonHandshake>& payload)
     {
-        ClientLogonHandshake clientHandshake;
-        clientHandshake.Deserialize(packet->payload);
+        ClientLogonHandshake& clientHandshake = payload.value;
 
         entt::registry* registry = ServiceLocator::GetRegistry();
-        Authentication& authentication = registry->get<Authentication>(netClient->GetEntity());
+        entt::entity entity = netClient.GetEntity();
+
+        // Only one handshake per connection
+        Authentication& authentication = registry->get<Authentication>(entity);
+        if (authentication.isHandshakePending)
+            return false;
+
+        authentication.isHandshakePending = true;
+
+        AuthenticationSingleton& authenticationSingleton = registry->ctx<AuthenticationSingleton>();
+        authenticationSingleton.workers.Enqueue([entity, srp = authentication.srp, clientHandshake]() mutable -> AuthCompletion
+        {
+            bool isVerified = srp->VerifySession(clientHandshake.M1);
+
+            return [entity, isVerified](entt::registry& registry)
+            {
+                HandleSessionResult(registry, entity, isVerified);
+            };
+        });
 
-        if (!authentication.srp.VerifySession(clientHandshake.M1))
+        return true;
+    }
+    void AuthHandlers::HandleSessionResult(entt::registry& registry, entt::entity entity, bool isVerified)
+    {
+        ConnectionComponent* connection = GetConnection(registry, entity);
+        if (!connection)
+            return;
+
+        NetClient& netClient = *connection->netClient;
+        Authentication& authentication = registry.get<Authentication>(entity);
+        authentication.isHandshakePending = false;
+
+        AuthenticationSingleton& authenticationSingleton = registry.ctx<AuthenticationSingleton>();
+        if (!isVerified)
         {
+            authenticationSingleton.numFailedLogins++;
             DebugHandler::PrintWarning("Unsuccessful Login for: %s", authentication.username.c_str());
-            netClient->Close();
-            return true;
+            connection->channel->Close();
+            return;
         }
         else
         {
+            authenticationSingleton.numLogins++;
             DebugHandler::PrintSuccess("Successful Login for: %s", authentication.username.c_str());
         }
 
         ServerLogonHandshake serverHandsake;
-        std::memcpy(serverHandsake.HAMK, authentication.srp.HAMK, sizeof(authentication.srp.HAMK));
+        std::memcpy(serverHandsake.HAMK, authentication.srp->HAMK, sizeof(authentication.srp->HAMK));
 
         std::shared_ptr<Bytebuffer> buffer = Bytebuffer::Borrow<128>();
         buffer->Put(Opcode::SMSG_LOGON_HANDSHAKE);
@@ -124,9 +223,22 @@ namespace Client
 
         u16 payloadSize = serverHandsake.Serialize(buffer);
         buffer->Put<u16>(payloadSize, 2);
-        netClient->Send(buffer);
+        connection->AddPacket(buffer, PacketPriority::IMMEDIATE);
 
-        netClient->SetConnectionStatus(ConnectionStatus::AUTH_SUCCESS);
-        return true;
+        // Only now is the connection worth a full size receive ring
+        connection->channel->isAuthenticated = true;
+        netClient.SetConnectionStatus(ConnectionStatus::AUTH_SUCCESS);
+    }
+    ConnectionComponent* AuthHandlers::GetConnection(entt::registry& registry, entt::entity entity)
+    {
+        // Dropped while its request was running on a worker
+        if (!registry.valid(entity))
+            return nullptr;
+
+        ConnectionComponent* connection = registry.try_get<ConnectionComponent>(entity);
+        if (!connection || !connection->channel->IsConnected())
+            return nullptr;
+
+        return connection;
     }
 }
\ No newline at end of file
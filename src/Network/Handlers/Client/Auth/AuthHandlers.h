@@ -1,16 +1,35 @@
 #pragma once
+#include <Networking/NetStructures.h>
+#include <entity/fwd.hpp>
 #include <memory>
+#include "../../../OpcodeDispatch.h"
+#include "../../../AccountCache.h"
 
-class NetPacketHandler;
 class NetClient;
-struct NetPacket;
+class QueryResult;
+struct ConnectionComponent;
+struct Authentication;
 namespace Client
 {
     class AuthHandlers
     {
     public:
-        static void Setup(NetPacketHandler*);
-        static bool HandshakeHandler(std::shared_ptr<NetClient>, std::shared_ptr<NetPacket>);
-        static bool HandshakeResponseHandler(std::shared_ptr<NetClient>, std::shared_ptr<NetPacket>);
+        static bool HandshakeHandler(NetClient&, DeserializedPayload<ClientLogonChallenge>&);
+        static bool HandshakeResponseHandler(NetClient&, DeserializedPayload<ClientLogonHandshake>&);
+
+    private:
+        // Applied on the tick by DBCompletionSystem once the account lookup of HandshakeHandler is done
+        // generation is the account cache's at the time of the query
+        static void HandleAccountResult(entt::registry& registry, entt::entity entity, const ClientLogonChallenge& logonChallenge, u64 generation, std::shared_ptr<QueryResult> result);
+
+        // Hands StartVerification to an auth worker, with the account either from the cache or straight from the database
+        static void QueueVerification(entt::registry& registry, entt::entity entity, Authentication& authentication, const ClientLogonChallenge& logonChallenge, const AccountCache::Entry& account);
+
+        // Applied on the tick by AuthCompletionSystem once an auth worker is done with the SRP math
+        static void HandleChallengeResult(entt::registry& registry, entt::entity entity, bool didStart);
+        static void HandleSessionResult(entt::registry& registry, entt::entity entity, bool isVerified);
+
+        // Nullptr if the connection went away while a worker had it
+        static ConnectionComponent* GetConnection(entt::registry& registry, entt::entity entity);
     };
 }
\ No newline at end of file
@@ -1,8 +1,8 @@
 #include "GeneralHandlers.h"
+#include "Auth/AuthHandlers.h"
 #include <Networking/NetStructures.h>
 #include <Networking/NetPacket.h>
 #include <Networking/NetClient.h>
-#include <Networking/NetPacketHandler.h>
 #include <Networking/PacketUtils.h>
 #include <Utils/StringUtils.h>
 
@@ -17,45 +17,67 @@
 #include "../../../Utils/ServiceLocator.h"
 #include "../../../ECS/Components/Network/ConnectionComponent.h"
 #include <Gameplay/Network/PacketWriter.h>
+#include "../../OpcodeDispatch.h"
 
 namespace Client
 {
-    void GeneralHandlers::Setup(NetPacketHandler* netPacketHandler)
+    bool MoveEntityPayload::Read(NetPacket& packet)
     {
-        netPacketHandler->SetMessageHandler(Opcode::CMSG_CONNECTED, { ConnectionStatus::AUTH_SUCCESS, 0, GeneralHandlers::HandleConnected });
-        netPacketHandler->SetMessageHandler(Opcode::MSG_MOVE_ENTITY, { ConnectionStatus::CONNECTED, sizeof(vec3) * 3, GeneralHandlers::HandleMoveEntity });
+        return packet.payload->Get(position) && packet.payload->Get(rotation) && packet.payload->Get(scale);
+    }
 
-        netPacketHandler->SetMessageHandler(Opcode::CMSG_STORELOC, { ConnectionStatus::CONNECTED, 1, 257, GeneralHandlers::HandleStoreLoc });
-        netPacketHandler->SetMessageHandler(Opcode::CMSG_GOTO, { ConnectionStatus::CONNECTED, 1, 257, GeneralHandlers::HandleGoto });
+    bool LocationNamePayload::Read(NetPacket& packet)
+    {
+        return packet.payload->GetString(name) && name.length() > 0 && name.length() <= 256;
     }
 
-    bool GeneralHandlers::HandleConnected(std::shared_ptr<NetClient> netClient, std::shared_ptr<NetPacket> packet)
+    constexpr u16 authChallengeMinSize = static_cast<u16>(sizeof(u8) * 4 + sizeof(u16) + 4 + 256);
+    constexpr u16 authChallengeMaxSize = authChallengeMinSize + 33;
+
+    using Dispatcher = OpcodeDispatchTable<
+        OpcodeHandler<Opcode::CMSG_LOGON_CHALLENGE, ConnectionStatus::AUTH_CHALLENGE, authChallengeMinSize, authChallengeMaxSize, DeserializedPayload<ClientLogonChallenge>, &AuthHandlers::HandshakeHandler>,
+        FixedOpcodeHandler<Opcode::CMSG_LOGON_HANDSHAKE, ConnectionStatus::AUTH_HANDSHAKE, DeserializedPayload<ClientLogonHandshake>, &AuthHandlers::HandshakeResponseHandler, sizeof(ClientLogonHandshake)>,
+        FixedOpcodeHandler<Opcode::CMSG_CONNECTED, ConnectionStatus::AUTH_SUCCESS, EmptyPayload, &GeneralHandlers::HandleConnected, 0>,
+        FixedOpcodeHandler<Opcode::MSG_MOVE_ENTITY, ConnectionStatus::CONNECTED, MoveEntityPayload, &GeneralHandlers::HandleMoveEntity, sizeof(vec3) * 3>,
+        OpcodeHandler<Opcode::CMSG_STORELOC, ConnectionStatus::CONNECTED, 1, 257, LocationNamePayload, &GeneralHandlers::HandleStoreLoc>,
+        OpcodeHandler<Opcode::CMSG_GOTO, ConnectionStatus::CONNECTED, 1, 257, LocationNamePayload, &GeneralHandlers::HandleGoto>
+    >;
+
+    // Defined next to the handlers so the hot ones (HandleMoveEntity) are inlined into the dispatch
+    bool Dispatch(NetClient& netClient, NetPacket& packet)
     {
-        netClient->SetConnectionStatus(ConnectionStatus::CONNECTED);
+        return Dispatcher::Dispatch(netClient, packet);
+    }
+
+    bool GeneralHandlers::HandleConnected(NetClient& netClient, EmptyPayload& /*payload*/)
+    {
+        netClient.SetConnectionStatus(ConnectionStatus::CONNECTED);
+        entt::registry* registry = ServiceLocator::GetRegistry();
+        ConnectionComponent& connection = registry->get<ConnectionComponent>(netClient.GetEntity());
 
         std::shared_ptr<Bytebuffer> buffer = Bytebuffer::Borrow<128>();
         buffer->Put(Opcode::SMSG_CONNECTED);
         buffer->PutU16(0);
-        netClient->Send(buffer);
+        connection.AddPacket(buffer, PacketPriority::IMMEDIATE);
 
         // Add Player Entity (Request to be handled later in this frame or early next frame)
         {
-            entt::registry* registry = ServiceLocator::GetRegistry();
-
             SpawnPlayerQueueSingleton& spawnPlayerQueueSingleton = registry->ctx<SpawnPlayerQueueSingleton>();
-            spawnPlayerQueueSingleton.spawnPlayerRequests.enqueue({ netClient });
+            spawnPlayerQueueSingleton.spawnPlayerRequests.enqueue({ connection.netClient });
         }
 
         return true;
     }
 
-    bool GeneralHandlers::HandleMoveEntity(std::shared_ptr<NetClient> netClient, std::shared_ptr<NetPacket> packet)
+    bool GeneralHandlers::HandleMoveEntity(NetClient& netClient, MoveEntityPayload& payload)
     {
         entt::registry* registry = ServiceLocator::GetRegistry();
-        const entt::entity& senderEntity = netClient->GetEntity();
+        const entt::entity& senderEntity = netClient.GetEntity();
 
         Transform& senderTransform = registry->get<Transform>(senderEntity);
-        packet->payload->Deserialize(senderTransform);
+        senderTransform.position = payload.position;
+        senderTransform.rotation = payload.rotation;
+        senderTransform.scale = payload.scale;
 
         // Validate Input
 
@@ -65,18 +87,14 @@ namespace Client
         return true;
     }
 
-    bool GeneralHandlers::HandleStoreLoc(std::shared_ptr<NetClient> netClient, std::shared_ptr<NetPacket> packet)
+    bool GeneralHandlers::HandleStoreLoc(NetClient& netClient, LocationNamePayload& payload)
     {
-        std::string name = "";
-        if (!packet->payload->GetString(name) || name.length() == 0 || name.length() > 256)
-            return false;
+        std::string& name = payload.name;
 
         entt::registry* registry = ServiceLocator::GetRegistry();
         DBSingleton& dbSingleton = registry->ctx<DBSingleton>();
         TeleportSingleton& teleportSingleton = registry->ctx<TeleportSingleton>();
 
-        name = dbSingleton.auth.EscapeSQL(name);
-
         std::shared_ptr<Bytebuffer> buffer = Bytebuffer::Borrow<512>();
         buffer->Put(Opcode::SMSG_STORELOC);
 
@@ -88,7 +106,7 @@ namespace Client
             // Success
             MapSingleton& mapSingleton = registry->ctx<MapSingleton>();
 
-            Transform& transform = registry->get<Transform>(netClient->GetEntity());
+            Transform& transform = registry->get<Transform>(netClient.GetEntity());
             TeleportLocation teleportLocation;
             {
                 teleportLocation.name = name;
@@ -107,10 +125,7 @@ namespace Client
 
             teleportSingleton.nameHashToLocation[nameHash] = teleportLocation;
 
-            std::stringstream ss;
-            ss << "INSERT INTO `teleportlocations` (`name`, `mapId`, `positionX`, `positionY`, `positionZ`, `orientation`) VALUES  ('" << name << "', " << teleportLocation.mapId << ", " << teleportLocation.position.x << ", " << teleportLocation.position.y << ", " << teleportLocation.position.z << ", " << teleportLocation.orientation << ");";
-            
-            dbSingleton.auth.Execute(ss.str());
+            dbSingleton.teleportLocations.Add({ teleportLocation.name, teleportLocation.mapId, teleportLocation.position.x, teleportLocation.position.y, teleportLocation.position.z, teleportLocation.orientation });
         }
         else
         {
@@ -122,20 +137,16 @@ namespace Client
             buffer->PutString(name);
         }
 
-        netClient->Send(buffer);
+        registry->get<ConnectionComponent>(netClient.GetEntity()).AddPacket(buffer, PacketPriority::IMMEDIATE);
         return true;
     }
-    bool GeneralHandlers::HandleGoto(std::shared_ptr<NetClient> netClient, std::shared_ptr<NetPacket> packet)
+    bool GeneralHandlers::HandleGoto(NetClient& netClient, LocationNamePayload& payload)
     {
-        std::string name = "";
-        if (!packet->payload->GetString(name) || name.length() == 0 || name.length() > 256)
-            return false;
+        std::string& name = payload.name;
 
         entt::registry* registry = ServiceLocator::GetRegistry();
-        DBSingleton& dbSingleton = registry->ctx<DBSingleton>();
         TeleportSingleton& teleportSingleton = registry->ctx<TeleportSingleton>();
 
-        name = dbSingleton.auth.EscapeSQL(name);
         u32 nameHash = StringUtils::fnv1a_32(name.c_str(), name.length());
 
         auto itr = teleportSingleton.nameHashToLocation.find(nameHash);
@@ -143,7 +154,7 @@ namespace Client
         {
             const TeleportLocation& teleportLocation = itr->second;
 
-            entt::entity entity = netClient->GetEntity();
+            entt::entity entity = netClient.GetEntity();
             Transform& transform = registry->get<Transform>(entity);
             transform.position = teleportLocation.position;
             transform.rotation.z = glm::degrees(teleportLocation.orientation);
@@ -153,7 +164,7 @@ namespace Client
             std::shared_ptr<Bytebuffer> packetBuffer = nullptr;
             if (PacketWriter::SMSG_UPDATE_ENTITY(packetBuffer, entity, transform))
             {
-                netClient->Send(packetBuffer);
+                registry->get<ConnectionComponent>(entity).AddPacket(packetBuffer, PacketPriority::IMMEDIATE);
             }
         }
 
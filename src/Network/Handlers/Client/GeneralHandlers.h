@@ -1,18 +1,37 @@
 #pragma once
-#include <memory>
+#include <NovusTypes.h>
+#include <string>
 
-class NetPacketHandler;
 class NetClient;
 struct NetPacket;
+struct EmptyPayload;
 namespace Client
 {
+    struct MoveEntityPayload
+    {
+        vec3 position;
+        vec3 rotation;
+        vec3 scale;
+
+        bool Read(NetPacket& packet);
+    };
+
+    struct LocationNamePayload
+    {
+        std::string name;
+
+        bool Read(NetPacket& packet);
+    };
+
     class GeneralHandlers
     {
     public:
-        static void Setup(NetPacketHandler*);
-        static bool HandleConnected(std::shared_ptr<NetClient>, std::shared_ptr<NetPacket>);
-        static bool HandleMoveEntity(std::shared_ptr<NetClient>, std::shared_ptr<NetPacket>);
-        static bool HandleStoreLoc(std::shared_ptr<NetClient>, std::shared_ptr<NetPacket>);
-        static bool HandleGoto(std::shared_ptr<NetClient>, std::shared_ptr<NetPacket>);
+        static bool HandleConnected(NetClient&, EmptyPayload&);
+        static bool HandleMoveEntity(NetClient&, MoveEntityPayload&);
+        static bool HandleStoreLoc(NetClient&, LocationNamePayload&);
+        static bool HandleGoto(NetClient&, LocationNamePayload&);
     };
+
+    // Dispatches every opcode a client can send, returns false if the connection should be closed
+    bool Dispatch(NetClient& netClient, NetPacket& packet);
 }
\ No newline at end of file
@@ -3,7 +3,6 @@
 #include <Networking/NetStructures.h>
 #include <Networking/NetPacket.h>
 #include <Networking/NetClient.h>
-#include <Networking/NetPacketHandler.h>
 #include <Utils/ByteBuffer.h>
 #include "../../../../Utils/ServiceLocator.h"
 #include "../../../../ECS/Components/Network/AuthenticationSingleton.h"
@@ -14,15 +13,9 @@
 
 namespace InternalSocket
 {
-    void AuthHandlers::Setup(NetPacketHandler* netPacketHandler)
+    bool AuthHandlers::HandshakeHandler(NetClient& netClient, DeserializedPayload<ServerLogonChallenge>& payload)
     {
-        netPacketHandler->SetMessageHandler(Opcode::SMSG_LOGON_CHALLENGE, { ConnectionStatus::AUTH_CHALLENGE, sizeof(ServerLogonChallenge), AuthHandlers::HandshakeHandler });
-        netPacketHandler->SetMessageHandler(Opcode::SMSG_LOGON_HANDSHAKE, { ConnectionStatus::AUTH_HANDSHAKE, sizeof(ServerLogonHandshake), AuthHandlers::HandshakeResponseHandler });
-    }
-    bool AuthHandlers::HandshakeHandler(std::shared_ptr<NetClient> netClient, std::shared_ptr<NetPacket> packet)
-    {
-        ServerLogonChallenge logonChallenge;
-        logonChallenge.Deserialize(packet->payload);
+        ServerLogonChallenge& logonChallenge = payload.value;
 
         entt::registry* registry = ServiceLocator::GetRegistry();
         AuthenticationSingleton& authenticationSingleton = registry->ctx<AuthenticationSingleton>();
@@ -30,7 +23,7 @@ namespace InternalSocket
         // If "ProcessChallenge" fails, we have either hit a bad memory allocation or a SRP-6a safety check, thus we should close the connection
         if (!authenticationSingleton.srp.ProcessChallenge(logonChallenge.s, logonChallenge.B))
         {
-            netClient->Close();
+            netClient.Close();
             return true;
         }
 
@@ -44,16 +37,15 @@ namespace InternalSocket
 
         u16 payloadSize = clientResponse.Serialize(buffer);
         buffer->Put<u16>(payloadSize, 2);
-        netClient->Send(buffer);
+        netClient.Send(buffer);
 
-        netClient->SetConnectionStatus(ConnectionStatus::AUTH_HANDSHAKE);
+        netClient.SetConnectionStatus(ConnectionStatus::AUTH_HANDSHAKE);
         return true;
     }
-    bool AuthHandlers::HandshakeResponseHandler(std::shared_ptr<NetClient> netClient, std::shared_ptr<NetPacket> packet)
+    bool AuthHandlers::HandshakeResponseHandler(NetClient& netClient, DeserializedPayload<ServerLogonHandshake>& payload)
     {
         // Handle handshake response
-        ServerLogonHandshake logonResponse;
-        logonResponse.Deserialize(packet->payload);
+        ServerLogonHandshake& logonResponse = payload.value;
 
         entt::registry* registry = ServiceLocator::GetRegistry();
         AuthenticationSingleton& authenticationSingleton = registry->ctx<AuthenticationSingleton>();
@@ -62,7 +54,7 @@ namespace InternalSocket
         if (!authenticationSingleton.srp.VerifySession(logonResponse.HAMK))
         {
             DebugHandler::PrintWarning("Unsuccessful Login");
-            netClient->Close();
+            netClient.Close();
             return true;
         }
         else
@@ -80,9 +72,9 @@ namespace InternalSocket
         buffer->PutU32(connectionInfo.ipAddr);
         buffer->PutU16(connectionInfo.port);
 
-        netClient->Send(buffer);
+        netClient.Send(buffer);
 
-        netClient->SetConnectionStatus(ConnectionStatus::AUTH_SUCCESS);
+        netClient.SetConnectionStatus(ConnectionStatus::AUTH_SUCCESS);
         return true;
     }
 }
\ No newline at end of file
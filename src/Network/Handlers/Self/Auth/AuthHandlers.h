@@ -1,16 +1,14 @@
 #pragma once
-#include <memory>
+#include <Networking/NetStructures.h>
+#include "../../../OpcodeDispatch.h"
 
-class NetPacketHandler;
-struct NetPacket;
 class NetClient;
 namespace InternalSocket
 {
     class AuthHandlers
     {
     public:
-        static void Setup(NetPacketHandler*);
-        static bool HandshakeHandler(std::shared_ptr<NetClient>, std::shared_ptr<NetPacket>);
-        static bool HandshakeResponseHandler(std::shared_ptr<NetClient>, std::shared_ptr<NetPacket>);
+        static bool HandshakeHandler(NetClient&, DeserializedPayload<ServerLogonChallenge>&);
+        static bool HandshakeResponseHandler(NetClient&, DeserializedPayload<ServerLogonHandshake>&);
     };
 }
\ No newline at end of file
@@ -1,55 +1,79 @@
 #include "GeneralHandlers.h"
+#include "Auth/AuthHandlers.h"
 #include <entt.hpp>
 #include <Networking/NetStructures.h>
 #include <Networking/NetPacket.h>
 #include <Networking/NetClient.h>
-#include <Networking/NetPacketHandler.h>
 #include <Networking/PacketUtils.h>
 #include "../../../Utils/ServiceLocator.h"
 #include "../../../ECS/Components/Network/ConnectionComponent.h"
+#include "../../../ECS/Components/Network/AuthenticationSingleton.h"
+#include "../../OpcodeDispatch.h"
+#include "../../InternalOpcodes.h"
 
 namespace InternalSocket
 {
-    void GeneralHandlers::Setup(NetPacketHandler* netPacketHandler)
+    bool SendAddressPayload::Read(NetPacket& packet)
     {
-        netPacketHandler->SetMessageHandler(Opcode::SMSG_CONNECTED, { ConnectionStatus::AUTH_SUCCESS, 0, GeneralHandlers::HandleConnected });
-        netPacketHandler->SetMessageHandler(Opcode::SMSG_SEND_ADDRESS, { ConnectionStatus::CONNECTED, 1, sizeof(u8) + sizeof(u32) + sizeof(u16) + sizeof(entt::entity), GeneralHandlers::HandleSendAddress });
-    }
-
-    bool GeneralHandlers::HandleConnected(std::shared_ptr<NetClient> netClient, std::shared_ptr<NetPacket> packet)
-    {
-        netClient->SetConnectionStatus(ConnectionStatus::CONNECTED);
-        return true;
-    }
-    bool GeneralHandlers::HandleSendAddress(std::shared_ptr<NetClient> netClient, std::shared_ptr<NetPacket> packet)
-    {
-        u8 status = 0;
-        u32 address = 0;
-        u16 port = 0;
-        entt::entity entity = entt::null;
-
-        if (!packet->payload->GetU8(status))
+        if (!packet.payload->GetU8(status))
             return false;
 
         if (status > 0)
         {
-            if (!packet->payload->GetU32(address))
+            if (!packet.payload->GetU32(address))
                 return false;
 
-            if (!packet->payload->GetU16(port))
+            if (!packet.payload->GetU16(port))
                 return false;
         }
 
-        if (!packet->payload->Get(entity))
-            return false;
+        return packet.payload->Get(entity);
+    }
+
+    bool AccountChangedPayload::Read(NetPacket& packet)
+    {
+        return packet.payload->GetString(username) && username.length() > 0;
+    }
+
+    using Dispatcher = OpcodeDispatchTable<
+        FixedOpcodeHandler<Opcode::SMSG_LOGON_CHALLENGE, ConnectionStatus::AUTH_CHALLENGE, DeserializedPayload<ServerLogonChallenge>, &AuthHandlers::HandshakeHandler, sizeof(ServerLogonChallenge)>,
+        FixedOpcodeHandler<Opcode::SMSG_LOGON_HANDSHAKE, ConnectionStatus::AUTH_HANDSHAKE, DeserializedPayload<ServerLogonHandshake>, &AuthHandlers::HandshakeResponseHandler, sizeof(ServerLogonHandshake)>,
+        FixedOpcodeHandler<Opcode::SMSG_CONNECTED, ConnectionStatus::AUTH_SUCCESS, EmptyPayload, &GeneralHandlers::HandleConnected, 0>,
+        OpcodeHandler<Opcode::SMSG_SEND_ADDRESS, ConnectionStatus::CONNECTED, 1, sizeof(u8) + sizeof(u32) + sizeof(u16) + sizeof(entt::entity), SendAddressPayload, &GeneralHandlers::HandleSendAddress>,
+        OpcodeHandler<InternalOpcode::SMSG_ACCOUNT_CHANGED, ConnectionStatus::CONNECTED, 2, 256, AccountChangedPayload, &GeneralHandlers::HandleAccountChanged>
+    >;
 
+    bool Dispatch(NetClient& netClient, NetPacket& packet)
+    {
+        return Dispatcher::Dispatch(netClient, packet);
+    }
+
+    bool GeneralHandlers::HandleConnected(NetClient& netClient, EmptyPayload& /*payload*/)
+    {
+        netClient.SetConnectionStatus(ConnectionStatus::CONNECTED);
+
+#ifdef WORLD_ACCOUNT_CACHE
+        // From here on we hear about every password change, so verifiers can be cached again
+        entt::registry* registry = ServiceLocator::GetRegistry();
+        registry->ctx<AuthenticationSingleton>().accountCache.SetEnabled(true);
+#endif
+        return true;
+    }
+    bool GeneralHandlers::HandleSendAddress(NetClient& /*netClient*/, SendAddressPayload& payload)
+    {
         std::shared_ptr<Bytebuffer> buffer = Bytebuffer::Borrow<128>();
-        if (!PacketUtils::Write_SMSG_SEND_ADDRESS(buffer, status, address, port))
+        if (!PacketUtils::Write_SMSG_SEND_ADDRESS(buffer, payload.status, payload.address, payload.port))
             return false;
 
         entt::registry* registry = ServiceLocator::GetRegistry();
-        auto& connectionComponent = registry->get<ConnectionComponent>(entity);
-        connectionComponent.netClient->Send(buffer);
+        auto& connectionComponent = registry->get<ConnectionComponent>(payload.entity);
+        connectionComponent.AddPacket(buffer, PacketPriority::IMMEDIATE);
+        return true;
+    }
+    bool GeneralHandlers::HandleAccountChanged(NetClient& /*netClient*/, AccountChangedPayload& payload)
+    {
+        entt::registry* registry = ServiceLocator::GetRegistry();
+        registry->ctx<AuthenticationSingleton>().accountCache.Invalidate(payload.username);
         return true;
     }
 }
\ No newline at end of file
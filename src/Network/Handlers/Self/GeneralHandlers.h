@@ -1,16 +1,38 @@
 #pragma once
-#include <memory>
+#include <NovusTypes.h>
+#include <entity/fwd.hpp>
+#include <string>
 
-class NetPacketHandler;
 class NetClient;
 struct NetPacket;
+struct EmptyPayload;
 namespace InternalSocket
 {
+    struct SendAddressPayload
+    {
+        u8 status = 0;
+        u32 address = 0;
+        u16 port = 0;
+        entt::entity entity;
+
+        bool Read(NetPacket& packet);
+    };
+
+    struct AccountChangedPayload
+    {
+        std::string username;
+
+        bool Read(NetPacket& packet);
+    };
+
     class GeneralHandlers
     {
     public:
-        static void Setup(NetPacketHandler*);
-        static bool HandleConnected(std::shared_ptr<NetClient>, std::shared_ptr<NetPacket>);
-        static bool HandleSendAddress(std::shared_ptr<NetClient>, std::shared_ptr<NetPacket>);
+        static bool HandleConnected(NetClient&, EmptyPayload&);
+        static bool HandleSendAddress(NetClient&, SendAddressPayload&);
+        static bool HandleAccountChanged(NetClient&, AccountChangedPayload&);
     };
+
+    // Dispatches every opcode the auth server can send us, returns false if the link should be closed
+    bool Dispatch(NetClient& netClient, NetPacket& packet);
 }
\ No newline at end of file
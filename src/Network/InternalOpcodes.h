@@ -0,0 +1,18 @@
+#pragma once
+#include <NovusTypes.h>
+#include <Networking/NetPacket.h>
+
+// Opcodes only the auth server and the world server exchange over the internal link
+// NovusCore-Common doesn't know about them yet, they count down from the top of the range so a new shared opcode can't collide with them
+namespace InternalOpcode
+{
+    // The auth server has to send this over the internal link whenever the salt and verifier of an account change (or the account is deleted), the payload is the (null terminated) username
+    // The auth server doesn't send it yet, which is why the AccountCache it keeps correct is only built with WORLD_ENABLE_ACCOUNT_CACHE
+    // Without it a changed password would keep working here for up to ACCOUNT_CACHE_TTL
+    constexpr Opcode SMSG_ACCOUNT_CHANGED = static_cast<Opcode>(0xFFFE);
+
+    constexpr bool IsInternal(Opcode opcode)
+    {
+        return opcode == SMSG_ACCOUNT_CHANGED;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,203 @@
+#include "MovementReplication.h"
+#include <Utils/ByteBuffer.h>
+#include <entt.hpp>
+#include <cstring>
+
+// Small changes in either direction stay small, 0 -> 0, -1 -> 1, 1 -> 2, -2 -> 3...
+static u32 ZigZag(i32 value)
+{
+    return (static_cast<u32>(value) << 1) ^ static_cast<u32>(value >> 31);
+}
+
+static i32 UnZigZag(u32 value)
+{
+    return static_cast<i32>(value >> 1) ^ -static_cast<i32>(value & 1);
+}
+
+static u16 WriteVarInt(u8* data, u32 value)
+{
+    u16 size = 0;
+    while (value >= 0x80)
+    {
+        data[size++] = static_cast<u8>(value | 0x80);
+        value >>= 7;
+    }
+
+    data[size++] = static_cast<u8>(value);
+    return size;
+}
+
+static bool ReadVarInt(const u8* data, size_t size, size_t& offset, u32& value)
+{
+    value = 0;
+    for (u32 shift = 0; shift < 35; shift += 7)
+    {
+        if (offset >= size)
+            return false;
+
+        u8 byte = data[offset++];
+        value |= static_cast<u32>(byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+// Positions and scales wrap like the client's i32 does, so any two values have an exact delta
+static i32 GetDelta(i32 value, i32 baseline)
+{
+    return static_cast<i32>(static_cast<u32>(value) - static_cast<u32>(baseline));
+}
+
+static i32 ApplyDelta(i32 baseline, i32 delta)
+{
+    return static_cast<i32>(static_cast<u32>(baseline) + static_cast<u32>(delta));
+}
+
+namespace MovementReplication
+{
+    u16 WriteKeyframe(u8* payload, entt::entity entity, const QuantizedTransform& transform)
+    {
+        u32 entityId = entt::to_integral(entity);
+        std::memcpy(payload, &entityId, sizeof(u32));
+        payload[4] = MovementUpdateFlag::KEYFRAME;
+
+        u16 size = 5;
+        std::memcpy(&payload[size], transform.position, sizeof(transform.position));
+        size += sizeof(transform.position);
+        std::memcpy(&payload[size], transform.rotation, sizeof(transform.rotation));
+        size += sizeof(transform.rotation);
+        std::memcpy(&payload[size], transform.scale, sizeof(transform.scale));
+        size += sizeof(transform.scale);
+
+        return size;
+    }
+
+    u16 WriteDelta(u8* payload, entt::entity entity, const QuantizedTransform& baseline, const QuantizedTransform& transform)
+    {
+        u32 entityId = entt::to_integral(entity);
+        std::memcpy(payload, &entityId, sizeof(u32));
+
+        u8 flags = 0;
+        u16 size = 5;
+
+        for (u32 i = 0; i < 3; i++)
+        {
+            if (transform.position[i] == baseline.position[i])
+                continue;
+
+            flags |= MovementUpdateFlag::POSITION_X << i;
+            size += WriteVarInt(&payload[size], ZigZag(GetDelta(transform.position[i], baseline.position[i])));
+        }
+
+        for (u32 i = 0; i < 3; i++)
+        {
+            if (transform.rotation[i] == baseline.rotation[i])
+                continue;
+
+            // The shorter way around the circle
+            i16 delta = static_cast<i16>(static_cast<u16>(transform.rotation[i] - baseline.rotation[i]));
+
+            flags |= MovementUpdateFlag::ROTATION_X << i;
+            size += WriteVarInt(&payload[size], ZigZag(delta));
+        }
+
+        if (transform.scale[0] != baseline.scale[0] || transform.scale[1] != baseline.scale[1] || transform.scale[2] != baseline.scale[2])
+        {
+            flags |= MovementUpdateFlag::SCALE;
+            for (u32 i = 0; i < 3; i++)
+            {
+                size += WriteVarInt(&payload[size], ZigZag(GetDelta(transform.scale[i], baseline.scale[i])));
+            }
+        }
+
+        payload[4] = flags;
+        return size;
+    }
+
+    bool WriteUpdate(std::shared_ptr<Bytebuffer>& buffer, entt::entity entity, const QuantizedTransform* baseline, const QuantizedTransform& transform)
+    {
+        u8 payload[MOVEMENT_UPDATE_MAX_PAYLOAD_SIZE];
+        u16 payloadSize = 0;
+
+        if (baseline)
+        {
+            payloadSize = WriteDelta(payload, entity, *baseline, transform);
+        }
+
+        // A delta of mostly large jumps can come out bigger than the keyframe
+        if (!baseline || payloadSize >= MOVEMENT_UPDATE_KEYFRAME_SIZE)
+        {
+            payloadSize = WriteKeyframe(payload, entity, transform);
+        }
+
+        buffer = Bytebuffer::Borrow<sizeof(PacketHeader) + MOVEMENT_UPDATE_MAX_PAYLOAD_SIZE>();
+        if (!buffer->Put(SMSG_UPDATE_ENTITY_QUANTIZED))
+            return false;
+
+        if (!buffer->PutU16(payloadSize))
+            return false;
+
+        return buffer->PutBytes(payload, payloadSize);
+    }
+
+    bool ApplyUpdate(const u8* payload, size_t size, QuantizedTransform& state)
+    {
+        if (size < 5)
+            return false;
+
+        u8 flags = payload[4];
+        size_t offset = 5;
+
+        if (flags & MovementUpdateFlag::KEYFRAME)
+        {
+            if (size != MOVEMENT_UPDATE_KEYFRAME_SIZE)
+                return false;
+
+            std::memcpy(state.position, &payload[offset], sizeof(state.position));
+            offset += sizeof(state.position);
+            std::memcpy(state.rotation, &payload[offset], sizeof(state.rotation));
+            offset += sizeof(state.rotation);
+            std::memcpy(state.scale, &payload[offset], sizeof(state.scale));
+            return true;
+        }
+
+        u32 value = 0;
+        for (u32 i = 0; i < 3; i++)
+        {
+            if ((flags & (MovementUpdateFlag::POSITION_X << i)) == 0)
+                continue;
+
+            if (!ReadVarInt(payload, size, offset, value))
+                return false;
+
+            state.position[i] = ApplyDelta(state.position[i], UnZigZag(value));
+        }
+
+        for (u32 i = 0; i < 3; i++)
+        {
+            if ((flags & (MovementUpdateFlag::ROTATION_X << i)) == 0)
+                continue;
+
+            if (!ReadVarInt(payload, size, offset, value))
+                return false;
+
+            state.rotation[i] = static_cast<u16>(state.rotation[i] + UnZigZag(value));
+        }
+
+        if (flags & MovementUpdateFlag::SCALE)
+        {
+            for (u32 i = 0; i < 3; i++)
+            {
+                if (!ReadVarInt(payload, size, offset, value))
+                    return false;
+
+                state.scale[i] = ApplyDelta(state.scale[i], UnZigZag(value));
+            }
+        }
+
+        return offset == size;
+    }
+}
\ No newline at end of file
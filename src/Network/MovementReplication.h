@@ -0,0 +1,92 @@
+#pragma once
+#include <NovusTypes.h>
+#include <cmath>
+#include <memory>
+#include <entity/fwd.hpp>
+#include <Networking/NetPacket.h>
+#include <Gameplay/ECS/Components/Transform.h>
+
+class Bytebuffer;
+
+#define MOVEMENT_POSITION_STEPS_PER_YARD 32.0f
+#define MOVEMENT_ROTATION_STEPS_PER_DEGREE (65536.0f / 360.0f)
+#define MOVEMENT_SCALE_STEPS_PER_UNIT 256.0f
+
+// An observer gets a keyframe (the full quantized state) instead of a delta if its last one for the entity is older than this
+#define MOVEMENT_KEYFRAME_TIME 2.0f
+
+// Set to 0 at build time for clients that don't know SMSG_UPDATE_ENTITY_QUANTIZED yet, observers then get the full float SMSG_UPDATE_ENTITY again
+#ifndef MOVEMENT_QUANTIZED_UPDATES
+#define MOVEMENT_QUANTIZED_UPDATES 1
+#endif
+
+// Sent instead of SMSG_UPDATE_ENTITY, NovusCore-Common doesn't know it yet so it sits just below the internal opcodes at the top of the range
+// Payload: u32 entity, u8 flags (MovementUpdateFlag), then either
+// - a keyframe: i32 position[3], u16 rotation[3], i32 scale[3], the full quantized state
+// - a delta: for every flagged field, its change from the observer's baseline as a zigzag varint (rotation wraps at 16 bits)
+// The client keeps the quantized state of every entity it sees, seeded from SMSG_CREATE_ENTITY through QuantizedTransform::FromTransform
+constexpr Opcode SMSG_UPDATE_ENTITY_QUANTIZED = static_cast<Opcode>(0xFFF0);
+
+namespace MovementUpdateFlag
+{
+    constexpr u8 KEYFRAME = 1 << 0;
+    constexpr u8 POSITION_X = 1 << 1; // POSITION_X << axis
+    constexpr u8 ROTATION_X = 1 << 4; // ROTATION_X << axis
+    constexpr u8 SCALE = 1 << 7; // All three axes
+}
+
+// Entity, flags and the quantized position, rotation and scale
+#define MOVEMENT_UPDATE_KEYFRAME_SIZE 35
+
+// Entity, flags and three 5 byte varints for both position and scale plus three 3 byte ones for rotation
+#define MOVEMENT_UPDATE_MAX_PAYLOAD_SIZE 44
+
+// The precision observers actually care about, two transforms quantizing to the same value don't need to be replicated
+struct QuantizedTransform
+{
+    i32 position[3] = { 0, 0, 0 };
+    u16 rotation[3] = { 0, 0, 0 };
+    i32 scale[3] = { 0, 0, 0 };
+
+    static QuantizedTransform FromTransform(const Transform& transform)
+    {
+        QuantizedTransform quantized;
+
+        for (u32 i = 0; i < 3; i++)
+        {
+            quantized.position[i] = static_cast<i32>(std::round(transform.position[i] * MOVEMENT_POSITION_STEPS_PER_YARD));
+            quantized.scale[i] = static_cast<i32>(std::round(transform.scale[i] * MOVEMENT_SCALE_STEPS_PER_UNIT));
+
+            // Wraps around, 360 degrees and 0 degrees quantize to the same value
+            i32 rotation = static_cast<i32>(std::round(transform.rotation[i] * MOVEMENT_ROTATION_STEPS_PER_DEGREE));
+            quantized.rotation[i] = static_cast<u16>(rotation & 0xFFFF);
+        }
+
+        return quantized;
+    }
+
+    bool operator==(const QuantizedTransform& other) const
+    {
+        for (u32 i = 0; i < 3; i++)
+        {
+            if (position[i] != other.position[i] || rotation[i] != other.rotation[i] || scale[i] != other.scale[i])
+                return false;
+        }
+
+        return true;
+    }
+    bool operator!=(const QuantizedTransform& other) const { return !(*this == other); }
+};
+
+namespace MovementReplication
+{
+    // Write the SMSG_UPDATE_ENTITY_QUANTIZED payload into payload (MOVEMENT_UPDATE_MAX_PAYLOAD_SIZE bytes) and return its size
+    u16 WriteKeyframe(u8* payload, entt::entity entity, const QuantizedTransform& transform);
+    u16 WriteDelta(u8* payload, entt::entity entity, const QuantizedTransform& baseline, const QuantizedTransform& transform);
+
+    // Builds the whole packet, a delta against baseline or a keyframe if baseline is null (or the delta wouldn't be any smaller)
+    bool WriteUpdate(std::shared_ptr<Bytebuffer>& buffer, entt::entity entity, const QuantizedTransform* baseline, const QuantizedTransform& transform);
+
+    // What the client does with the payload, state is its copy of the entity named by the first 4 bytes, returns false if the payload is malformed
+    bool ApplyUpdate(const u8* payload, size_t size, QuantizedTransform& state);
+}
\ No newline at end of file
@@ -0,0 +1,269 @@
+#include "NetworkChannel.h"
+#include "NetworkIOThreadPool.h"
+#include "PacketStreamDecoder.h"
+#include "SocketReactor.h"
+#include <Networking/NetSocket.h>
+#include <Utils/DebugHandler.h>
+#include <cstring>
+
+#ifdef _WIN32
+#include <WinSock2.h>
+using SocketHandle = SOCKET;
+
+#define NETWORK_CHANNEL_SEND_FLAGS 0
+
+static bool IsWouldBlock() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+#else
+#include <sys/socket.h>
+#include <cerrno>
+using SocketHandle = i32;
+
+// A peer that went away fails the write instead of raising SIGPIPE
+#define NETWORK_CHANNEL_SEND_FLAGS MSG_NOSIGNAL
+
+static bool IsWouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR; }
+#endif
+
+ReceiveRing& NetworkChannel::PrepareReceiveRing()
+{
+    if (!receiveRing)
+    {
+        if (isAuthenticated.load(std::memory_order_acquire))
+        {
+            receiveRing = std::make_shared<ReceiveRing>();
+        }
+        else
+        {
+            receiveRing = std::make_shared<ReceiveRing>(RECEIVE_RING_HANDSHAKE_SIZE, RECEIVE_RING_HANDSHAKE_MAX_PACKETS);
+        }
+    }
+    else if (receiveRing->GetSize() < RECEIVE_RING_SIZE && isAuthenticated.load(std::memory_order_acquire))
+    {
+        // Whatever the client already sent past the handshake moves along, packets the tick still holds keep the old ring alive
+        std::shared_ptr<ReceiveRing> ring = std::make_shared<ReceiveRing>();
+        receiveRing->MoveUnreadTo(*ring);
+        receiveRing = std::move(ring);
+    }
+
+    receiveRing->Reclaim();
+    return *receiveRing;
+}
+
+u32 NetworkChannel::Receive()
+{
+    ReceiveRing& ring = PrepareReceiveRing();
+
+    SocketHandle handle = static_cast<SocketHandle>(netClient->GetSocket()->GetSocket());
+
+    // The free space might wrap around the end of the ring, so it takes at most two reads to fill it
+    // Nothing is read while the ring is full, the tick still holds everything in it
+    for (u32 i = 0; i < 2; i++)
+    {
+        size_t space = ring.GetContiguousSpace();
+        if (space == 0)
+            break;
+
+        i64 received = recv(handle, reinterpret_cast<char*>(ring.GetWritePointer()), static_cast<i32>(space), 0);
+        if (received <= 0)
+        {
+            if (received < 0 && IsWouldBlock())
+                break;
+
+            HangUp();
+            return 0;
+        }
+
+        ring.SkipWrite(static_cast<size_t>(received));
+
+        if (static_cast<size_t>(received) < space)
+            break;
+    }
+
+    u32 numPackets = 0;
+    if (!Frame(numPackets))
+    {
+        HangUp();
+    }
+
+    return numPackets;
+}
+
+bool NetworkChannel::Frame(u32& numPackets)
+{
+    ReceiveRing& ring = *receiveRing;
+
+    auto sink = [this, &ring](const PacketHeader& header)
+    {
+        if (!ring.HasFreeSlot())
+            return false;
+
+        packetQueue.enqueue(ring.Frame(header));
+        return true;
+    };
+
+    PacketStreamResult result = isInternalLink ? PacketStreamDecoder<RECEIVE_RING_MAX_PAYLOAD_SIZE, true>::Decode(ring, sink, numPackets) : PacketStreamDecoder<RECEIVE_RING_MAX_PAYLOAD_SIZE>::Decode(ring, sink, numPackets);
+
+    switch (result)
+    {
+        case PacketStreamResult::NEED_MORE_DATA:
+        {
+            if (ring.GetSpace() > 0)
+            {
+                isReadPaused = false;
+                return true;
+            }
+
+            // Nothing in the ring is held by the tick, the packet we're waiting on is bigger than the ring will ever be
+            // The handshake ring is exempt once authenticated, the next read trades it for a full one
+            if (ring.GetActiveSize() == ring.GetSize() && (ring.GetSize() >= RECEIVE_RING_SIZE || !isAuthenticated.load(std::memory_order_acquire)))
+            {
+                DebugHandler::PrintWarning("[Network/Channel]: Packet doesn't fit the receive ring, closing connection");
+                return false;
+            }
+
+            isReadPaused = true;
+            return true;
+        }
+
+        case PacketStreamResult::SINK_FULL:
+            // Every slot is still held by a packet the tick hasn't handled, the rest is framed once it releases them
+            isReadPaused = true;
+            return true;
+
+        case PacketStreamResult::INVALID_OPCODE:
+#ifdef NC_Debug
+            DebugHandler::PrintError("Received Invalid Opcode from network stream");
+#endif // NC_Debug
+            return false;
+
+        case PacketStreamResult::INVALID_SIZE:
+#ifdef NC_Debug
+            DebugHandler::PrintError("Received Invalid Opcode Size from network stream");
+#endif // NC_Debug
+            return false;
+    }
+
+    return false;
+}
+
+void NetworkChannel::Close()
+{
+    if (isClosePending.exchange(true))
+        return;
+
+    if (!HasIOThread())
+    {
+        // Already closed when it hung up
+        if (!isHungUp)
+        {
+            CloseOnTick();
+        }
+
+        return;
+    }
+
+    ioThread->Close(*this);
+}
+
+void NetworkChannel::HangUp()
+{
+    if (isHungUp.exchange(true))
+        return;
+
+    if (!HasIOThread() && !isClosePending)
+    {
+        CloseOnTick();
+    }
+}
+
+void NetworkChannel::CloseOnTick()
+{
+    // Out of the reactor before the handle is closed, a new connection might get the same one right away
+    // epoll never reports a handle we closed, so the reactor reports it once more for the tick to drop the connection
+    if (reactor)
+    {
+        reactor->Unregister(netClient->GetSocket(), token);
+        reactor->ReportReady(token);
+    }
+
+    netClient->Close();
+}
+
+bool NetworkChannel::WriteUnsent()
+{
+    SocketHandle handle = static_cast<SocketHandle>(netClient->GetSocket()->GetSocket());
+
+    size_t writtenBytes = 0;
+    while (!unsentBuffers.empty())
+    {
+        const Bytebuffer& buffer = *unsentBuffers.front();
+        size_t size = buffer.writtenData - unsentOffset;
+
+        i64 written = send(handle, reinterpret_cast<const char*>(buffer.GetDataPointer() + unsentOffset), static_cast<i32>(size), NETWORK_CHANNEL_SEND_FLAGS);
+        if (written < 0)
+        {
+            if (IsWouldBlock())
+                break;
+
+            pendingSendBytes -= writtenBytes;
+            DropUnsent();
+            HangUp();
+            return false;
+        }
+
+        writtenBytes += static_cast<size_t>(written);
+        unsentOffset += static_cast<size_t>(written);
+
+        // The peer's receive window is full, the rest waits until the socket is writable again
+        if (unsentOffset < buffer.writtenData)
+            break;
+
+        unsentBuffers.pop_front();
+        unsentOffset = 0;
+    }
+
+    pendingSendBytes -= writtenBytes;
+    return true;
+}
+
+void NetworkChannel::DropUnsent()
+{
+    size_t droppedBytes = 0;
+    for (const std::shared_ptr<Bytebuffer>& buffer : unsentBuffers)
+    {
+        droppedBytes += buffer->writtenData;
+    }
+
+    pendingSendBytes -= droppedBytes - unsentOffset;
+
+    unsentBuffers.clear();
+    unsentOffset = 0;
+}
+
+void NetworkChannel::Send(const PacketSegment& segment)
+{
+    {
+        std::lock_guard<std::mutex> lock(sendMutex);
+        sendQueue.push_back(segment);
+    }
+
+    pendingSendBytes += segment.GetSize();
+    ioThread->ScheduleSend(*this);
+}
+
+void NetworkChannel::Send(PacketSendQueue& queue)
+{
+    {
+        std::lock_guard<std::mutex> lock(sendMutex);
+        for (const QueuedSegment& queuedSegment : queue.segments)
+        {
+            if (!queuedSegment.segment.IsEmpty())
+                sendQueue.push_back(queuedSegment.segment);
+        }
+    }
+
+    pendingSendBytes += queue.queuedBytes;
+
+    queue.Clear();
+    ioThread->ScheduleSend(*this);
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#pragma once
+#include <NovusTypes.h>
+#include <Utils/ConcurrentQueue.h>
+#include <Networking/NetPacket.h>
+#include <Networking/NetClient.h>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "PacketSegment.h"
+#include "ReceiveRing.h"
+
+// Initial capacity only, the queue grows on demand so thousands of connections waiting on authentication stay cheap
+#define NETWORK_CHANNEL_PACKET_QUEUE_SIZE 32
+
+class NetworkIOThread;
+class SocketReactor;
+
+// Everything the tick and a network I/O thread share about a single connection
+// The tick only ever consumes packetQueue and produces into sendQueue, the I/O thread does the opposite
+// Once an I/O thread owns the socket it is the only one closing the NetClient, the tick asks it to through Close()
+struct NetworkChannel : public std::enable_shared_from_this<NetworkChannel>
+{
+    NetworkChannel(std::shared_ptr<NetClient> inNetClient, u64 inToken, bool inIsInternalLink = false) : netClient(std::move(inNetClient)), token(inToken), isInternalLink(inIsInternalLink), packetQueue(NETWORK_CHANNEL_PACKET_QUEUE_SIZE) { }
+
+    std::shared_ptr<NetClient> netClient;
+    u64 token;
+
+    // The link to the auth server, the only one framing InternalOpcodes
+    const bool isInternalLink;
+
+    // Decoded packets waiting for the tick, they are views into receiveRing
+    moodycamel::ConcurrentQueue<std::shared_ptr<NetPacket>> packetQueue;
+
+    // Only touched by whoever reads the socket, see PrepareReceiveRing()
+    std::shared_ptr<ReceiveRing> receiveRing;
+
+    // Set by the tick once the client authenticated, the reader then trades the handshake ring for a full one
+    std::atomic<bool> isAuthenticated = { false };
+
+    // Segments that are due, written by the I/O thread as soon as it wakes up
+    // Guarded by a lock rather than a concurrent queue, the tick runs on a different worker every frame and segments must stay in order
+    std::mutex sendMutex;
+    std::vector<PacketSegment> sendQueue;
+
+    // Bytes handed to the I/O thread that the socket hasn't taken yet, grows while the peer's receive window is closed
+    std::atomic<size_t> pendingSendBytes = { 0 };
+
+    // Only touched by an epoll I/O thread, coalesced writes the socket didn't take yet in order, the first one is written up to unsentOffset
+    std::deque<std::shared_ptr<Bytebuffer>> unsentBuffers;
+    size_t unsentOffset = 0;
+
+    // The I/O thread owning the socket, null when the tick reads and writes it itself
+    NetworkIOThread* ioThread = nullptr;
+
+    // The tick's reactor the socket is registered with when the tick owns it, a close takes it out before the handle goes away
+    SocketReactor* reactor = nullptr;
+
+    // Set while the token sits in the I/O thread pool's ready queue, so it's only queued once per tick
+    std::atomic<bool> isPendingTick = { false };
+
+    // Set while the channel sits in its I/O thread's send queue, so the thread is only woken once per batch
+    std::atomic<bool> isPendingSend = { false };
+
+    // Set by the reader once the peer hung up or broke the protocol, an I/O thread leaves the socket open until the tick has it closed
+    std::atomic<bool> isHungUp = { false };
+
+    // Set by the tick once it asked the I/O thread to close the socket, the tick doesn't touch the NetClient's connection state after that
+    std::atomic<bool> isClosePending = { false };
+
+    // Set by the reader while the receive ring has no space or packet slots left, the socket isn't read until the tick releases packets
+    // Whatever the peer keeps sending stays in the kernel and TCP flow control holds it back
+    std::atomic<bool> isReadPaused = { false };
+
+    bool HasIOThread() const { return ioThread != nullptr; }
+
+    // What both sides check instead of NetClient::IsConnected(), the NetClient is never read once the I/O thread may be closing it
+    bool IsConnected() const { return !isHungUp.load(std::memory_order_acquire) && !isClosePending.load(std::memory_order_acquire) && netClient->IsConnected(); }
+
+    // Called by the tick, closes the socket right away if the tick owns it, otherwise the owning I/O thread closes it as soon as it wakes
+    // Either way the connection counts as disconnected from here on and is reported to the tick once more so it gets dropped
+    void Close();
+
+    // Called by the reader when the socket hung up or the stream is corrupt
+    // An I/O thread only marks the channel, so the handle can't be closed and handed to a new connection while the tick still uses this one
+    void HangUp();
+
+    // Close() and HangUp() when the tick owns the socket
+    void CloseOnTick();
+
+    // Creates the receive ring on first use, a small one until the connection is authenticated
+    // Only called by whoever reads the socket, right before it receives into the ring
+    ReceiveRing& PrepareReceiveRing();
+
+    // Reads whatever the socket has straight into the receive ring and frames it in place into packetQueue
+    // Returns the number of packets framed, the connection is hung up (see HangUp()) if the socket hung up or the stream is corrupt
+    // Reading pauses (see isReadPaused) while the ring is full, calling it again once the tick released packets picks up where it stopped
+    u32 Receive();
+
+    // Frames every complete packet, returns false if the stream is corrupt or holds a packet that can never fit the ring
+    // Sets isReadPaused if the ring ran out of space or packet slots
+    bool Frame(u32& numPackets);
+
+    // Writes as much of unsentBuffers as the socket takes without blocking, pendingSendBytes is only released for what it took
+    // Returns false if the socket is gone, the connection is hung up then (see HangUp()) and everything unsent is dropped
+    bool WriteUnsent();
+    bool HasUnsent() const { return !unsentBuffers.empty(); }
+
+    // Drops everything unsent and releases its pendingSendBytes, for connections that are going away
+    void DropUnsent();
+
+    // Hands segments to the I/O thread, only valid when HasIOThread()
+    void Send(const PacketSegment& segment);
+    void Send(PacketSendQueue& queue);
+};
\ No newline at end of file
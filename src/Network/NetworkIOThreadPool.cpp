@@ -0,0 +1,481 @@
+#include "NetworkIOThreadPool.h"
+#include "NetworkChannel.h"
+#include <Networking/NetClient.h>
+#include <Utils/DebugHandler.h>
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+
+// Lets PacketCoalescer hand its writes to io_uring instead of NetClient
+struct UringSink
+{
+    NetworkUring& uring;
+    u64 token;
+
+    void Send(std::shared_ptr<Bytebuffer> buffer) { uring.Send(token, std::move(buffer)); }
+};
+
+// Lets PacketCoalescer queue its writes on the channel, NetworkChannel::WriteUnsent() then writes what the socket takes
+struct UnsentSink
+{
+    NetworkChannel& channel;
+
+    void Send(std::shared_ptr<Bytebuffer> buffer) { channel.unsentBuffers.push_back(std::move(buffer)); }
+};
+
+bool NetworkIOThread::Start(NetworkIOBackend backend)
+{
+    if (backend == NetworkIOBackend::URING && _uring.Init())
+    {
+        _backend = NetworkIOBackend::URING;
+        _isRunning = true;
+        _thread = std::thread(&NetworkIOThread::RunUring, this);
+        return true;
+    }
+
+    if (!_reactor.IsAvailable() || !_reactor.EnableWake())
+        return false;
+
+    _backend = NetworkIOBackend::EPOLL;
+    _isRunning = true;
+    _thread = std::thread(&NetworkIOThread::Run, this);
+    return true;
+}
+
+void NetworkIOThread::Stop()
+{
+    if (!_thread.joinable())
+        return;
+
+    _isRunning = false;
+    if (_backend == NetworkIOBackend::URING)
+    {
+        _uring.Wake();
+    }
+    else
+    {
+        _reactor.Wake();
+    }
+
+    _thread.join();
+}
+
+void NetworkIOThread::Add(std::shared_ptr<NetworkChannel> channel)
+{
+    channel->ioThread = this;
+    _numChannels++;
+
+    _commands.enqueue({ std::move(channel), Command::Type::ADD });
+    Wake();
+}
+
+void NetworkIOThread::Remove(std::shared_ptr<NetworkChannel> channel)
+{
+    _numChannels--;
+
+    _commands.enqueue({ std::move(channel), Command::Type::REMOVE });
+    Wake();
+}
+
+void NetworkIOThread::Close(NetworkChannel& channel)
+{
+    _commands.enqueue({ channel.shared_from_this(), Command::Type::CLOSE });
+    Wake();
+}
+
+void NetworkIOThread::ScheduleSend(NetworkChannel& channel)
+{
+    // Already scheduled, the thread picks up everything queued until it gets to the channel
+    if (channel.isPendingSend.exchange(true))
+        return;
+
+    _pendingSends.enqueue(channel.token);
+    Wake();
+}
+
+void NetworkIOThread::Run()
+{
+    tracy::SetThreadName("NetworkIOThread");
+
+    while (_isRunning)
+    {
+        _reactor.Poll(_readyTokens, _writableTokens, NETWORK_IO_POLL_TIMEOUT_MS);
+        _isWakePending = false;
+
+        ZoneScopedNC("NetworkIOThread::Update", tracy::Color::Blue);
+
+        HandleCommands();
+        HandlePausedReads();
+
+        for (u64 token : _readyTokens)
+        {
+            auto itr = _channels.find(token);
+            if (itr == _channels.end())
+                continue;
+
+            // Only reported for a hangup while paused, the write below or the resume finds out about it
+            NetworkChannel& channel = *itr->second;
+            if (channel.isReadPaused || !channel.IsConnected())
+                continue;
+
+            HandleRead(channel);
+        }
+
+        for (u64 token : _writableTokens)
+        {
+            auto itr = _channels.find(token);
+            if (itr == _channels.end())
+                continue;
+
+            HandleWrite(*itr->second);
+        }
+
+        HandleSends();
+    }
+}
+
+// Reads are completed by the kernel straight into the receive rings, we only frame them and hand sends back
+// Every send the tick gave us during one iteration goes to the kernel in the next single submission
+void NetworkIOThread::RunUring()
+{
+    tracy::SetThreadName("NetworkIOThread");
+
+    while (_isRunning)
+    {
+        _uring.Submit(_readyTokens, NETWORK_IO_POLL_TIMEOUT_MS);
+        _isWakePending = false;
+
+        ZoneScopedNC("NetworkIOThread::Update", tracy::Color::Blue);
+
+        for (u64 token : _readyTokens)
+        {
+            auto itr = _channels.find(token);
+            if (itr == _channels.end())
+                continue;
+
+            _pool.QueueForTick(*itr->second);
+        }
+
+        HandleCommands();
+        HandleSends();
+    }
+}
+
+void NetworkIOThread::Wake()
+{
+    // One wakeup is enough no matter how many times the tick pokes us before we get to run
+    if (_isWakePending.exchange(true))
+        return;
+
+    if (_backend == NetworkIOBackend::URING)
+    {
+        _uring.Wake();
+    }
+    else
+    {
+        _reactor.Wake();
+    }
+}
+
+void NetworkIOThread::HandleCommands()
+{
+    Command command;
+    while (_commands.try_dequeue(command))
+    {
+        NetworkChannel& channel = *command.channel;
+
+        if (command.type == Command::Type::ADD)
+        {
+            _channels[channel.token] = command.channel;
+
+            if (_backend == NetworkIOBackend::URING)
+            {
+                _uring.Add(command.channel);
+            }
+            else if (!_reactor.Register(channel.netClient->GetSocket(), channel.token))
+            {
+                // Never going to be reported ready, let the tick find out it's gone
+                channel.HangUp();
+                _pool.QueueForTick(channel);
+            }
+        }
+        else if (command.type == Command::Type::CLOSE)
+        {
+            // Removed from the reactor before the handle is closed, a new connection might get the same one right away
+            if (_backend == NetworkIOBackend::URING)
+            {
+                _uring.Close(channel.token);
+            }
+            else
+            {
+                _reactor.Unregister(channel.netClient->GetSocket(), channel.token);
+                _pausedTokens.erase(std::remove(_pausedTokens.begin(), _pausedTokens.end(), channel.token), _pausedTokens.end());
+                channel.DropUnsent();
+            }
+
+            channel.netClient->Close();
+
+            // The tick might never hear from this socket again, so it's told to drop the connection
+            _pool.QueueForTick(channel);
+        }
+        else
+        {
+            if (_backend == NetworkIOBackend::URING)
+            {
+                _uring.Remove(channel.token);
+            }
+            else
+            {
+                _reactor.Unregister(channel.netClient->GetSocket(), channel.token);
+                _pausedTokens.erase(std::remove(_pausedTokens.begin(), _pausedTokens.end(), channel.token), _pausedTokens.end());
+                channel.DropUnsent();
+            }
+
+            // A socket that hung up is still open, the tick dropping the connection is our cue to close it
+            if (channel.netClient->IsConnected())
+            {
+                channel.netClient->Close();
+            }
+
+            _channels.erase(channel.token);
+        }
+    }
+}
+
+void NetworkIOThread::HandleRead(NetworkChannel& channel)
+{
+    NetClient& netClient = *channel.netClient;
+
+    u32 numPackets = channel.Receive();
+
+    if (!channel.IsConnected())
+    {
+        // Level triggered, a socket that hung up would be reported on every poll until the tick gets around to dropping it
+        _reactor.Unregister(netClient.GetSocket(), channel.token);
+        channel.DropUnsent();
+        _pool.QueueForTick(channel);
+        return;
+    }
+
+    if (numPackets > 0)
+    {
+        _pool.QueueForTick(channel);
+    }
+
+    // Level triggered, a socket we stopped reading would be reported on every poll, so it isn't watched for reads until the ring has room again
+    if (channel.isReadPaused)
+    {
+        _pausedTokens.push_back(channel.token);
+        UpdateInterest(channel);
+    }
+}
+
+void NetworkIOThread::HandlePausedReads()
+{
+    if (_pausedTokens.empty())
+        return;
+
+    _pausedScratch.swap(_pausedTokens);
+
+    for (u64 token : _pausedScratch)
+    {
+        auto itr = _channels.find(token);
+        if (itr == _channels.end())
+            continue;
+
+        NetworkChannel& channel = *itr->second;
+
+        // Hung up while paused, the tick is already on its way to drop it
+        if (!channel.IsConnected())
+            continue;
+
+        // Takes back whatever the tick released, frames what was waiting for a slot and reads into the space left
+        u32 numPackets = channel.Receive();
+
+        if (!channel.IsConnected())
+        {
+            _reactor.Unregister(channel.netClient->GetSocket(), token);
+            channel.DropUnsent();
+            _pool.QueueForTick(channel);
+            continue;
+        }
+
+        if (numPackets > 0)
+        {
+            _pool.QueueForTick(channel);
+        }
+
+        if (channel.isReadPaused)
+        {
+            _pausedTokens.push_back(token);
+        }
+        else
+        {
+            UpdateInterest(channel);
+        }
+    }
+
+    _pausedScratch.clear();
+}
+
+void NetworkIOThread::HandleSends()
+{
+    u64 token;
+    while (_pendingSends.try_dequeue(token))
+    {
+        auto itr = _channels.find(token);
+        if (itr == _channels.end())
+            continue;
+
+        NetworkChannel& channel = *itr->second;
+
+        // Cleared before taking the segments, anything queued after this schedules the channel again
+        channel.isPendingSend = false;
+
+        {
+            std::lock_guard<std::mutex> lock(channel.sendMutex);
+            _sendScratch.swap(channel.sendQueue);
+        }
+
+        // The kernel writes these whenever the socket can take them, pendingSendBytes is released as they complete
+        if (_backend == NetworkIOBackend::URING)
+        {
+            UringSink sink = { _uring, channel.token };
+            BasicPacketCoalescer<UringSink> coalescer(sink);
+            for (const PacketSegment& segment : _sendScratch)
+            {
+                coalescer.Add(segment);
+            }
+
+            coalescer.Finish();
+            _sendScratch.clear();
+            continue;
+        }
+
+        if (!channel.IsConnected())
+        {
+            size_t droppedBytes = 0;
+            for (const PacketSegment& segment : _sendScratch)
+            {
+                droppedBytes += segment.GetSize();
+            }
+
+            channel.pendingSendBytes -= droppedBytes;
+            _sendScratch.clear();
+            continue;
+        }
+
+        // Queued behind whatever the socket didn't take last time, pendingSendBytes is released as the socket takes it
+        {
+            UnsentSink sink = { channel };
+            BasicPacketCoalescer<UnsentSink> coalescer(sink);
+            for (const PacketSegment& segment : _sendScratch)
+            {
+                coalescer.Add(segment);
+            }
+
+            coalescer.Finish();
+            _sendScratch.clear();
+        }
+
+        HandleWrite(channel);
+    }
+}
+
+void NetworkIOThread::HandleWrite(NetworkChannel& channel)
+{
+    if (!channel.IsConnected())
+        return;
+
+    if (!channel.WriteUnsent())
+    {
+        _reactor.Unregister(channel.netClient->GetSocket(), channel.token);
+        _pool.QueueForTick(channel);
+        return;
+    }
+
+    UpdateInterest(channel);
+}
+
+void NetworkIOThread::UpdateInterest(NetworkChannel& channel)
+{
+    if (_reactor.SetInterest(channel.netClient->GetSocket(), channel.token, !channel.isReadPaused, channel.HasUnsent()))
+        return;
+
+    // Never going to be reported ready again, let the tick find out it's gone
+    _reactor.Unregister(channel.netClient->GetSocket(), channel.token);
+    channel.DropUnsent();
+    channel.HangUp();
+    _pool.QueueForTick(channel);
+}
+
+bool NetworkIOThreadPool::Start(u32 numThreads, NetworkIOBackend backend)
+{
+    for (u32 i = 0; i < numThreads; i++)
+    {
+        std::unique_ptr<NetworkIOThread> thread = std::make_unique<NetworkIOThread>(*this);
+        if (!thread->Start(backend))
+        {
+            DebugHandler::PrintWarning("[Network/IO]: Failed to start network I/O thread, sockets will be polled by the tick instead");
+            Stop();
+            return false;
+        }
+
+        _threads.push_back(std::move(thread));
+    }
+
+    if (IsRunning())
+    {
+        DebugHandler::PrintSuccess("[Network/IO]: Started %u network I/O threads (%s)", GetNumThreads(), GetBackend() == NetworkIOBackend::URING ? "io_uring" : "epoll");
+    }
+
+    return IsRunning();
+}
+
+void NetworkIOThreadPool::Stop()
+{
+    for (std::unique_ptr<NetworkIOThread>& thread : _threads)
+    {
+        thread->Stop();
+    }
+
+    _threads.clear();
+}
+
+void NetworkIOThreadPool::Add(std::shared_ptr<NetworkChannel> channel)
+{
+    NetworkIOThread* leastLoadedThread = _threads[0].get();
+    for (std::unique_ptr<NetworkIOThread>& thread : _threads)
+    {
+        if (thread->GetNumChannels() < leastLoadedThread->GetNumChannels())
+            leastLoadedThread = thread.get();
+    }
+
+    leastLoadedThread->Add(std::move(channel));
+}
+
+void NetworkIOThreadPool::Remove(const std::shared_ptr<NetworkChannel>& channel)
+{
+    if (channel->ioThread)
+    {
+        channel->ioThread->Remove(channel);
+    }
+}
+
+void NetworkIOThreadPool::GetReadyTokens(std::vector<u64>& readyTokens)
+{
+    readyTokens.clear();
+
+    u64 token;
+    while (_readyTokens.try_dequeue(token))
+    {
+        readyTokens.push_back(token);
+    }
+}
+
+void NetworkIOThreadPool::QueueForTick(NetworkChannel& channel)
+{
+    if (channel.isPendingTick.exchange(true))
+        return;
+
+    _readyTokens.enqueue(channel.token);
+}
\ No newline at end of file
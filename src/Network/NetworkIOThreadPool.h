@@ -0,0 +1,142 @@
+#pragma once
+#include <NovusTypes.h>
+#include <Utils/ConcurrentQueue.h>
+#include <robin_hood.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "SocketReactor.h"
+#include "NetworkUring.h"
+#include "PacketSegment.h"
+
+// Number of threads owning client sockets, 0 keeps reading and writing every socket on the tick thread
+#ifndef NETWORK_IO_THREAD_COUNT
+#define NETWORK_IO_THREAD_COUNT 2
+#endif
+
+// Upper bound on how long an idle I/O thread sleeps before checking whether it should stop
+#define NETWORK_IO_POLL_TIMEOUT_MS 100
+
+enum class NetworkIOBackend
+{
+    EPOLL,
+    URING // Falls back to EPOLL if we were built without WORLD_IO_URING or the kernel doesn't support it
+};
+
+#ifdef WORLD_IO_URING
+#define NETWORK_IO_BACKEND NetworkIOBackend::URING
+#else
+#define NETWORK_IO_BACKEND NetworkIOBackend::EPOLL
+#endif
+
+struct NetworkChannel;
+class NetworkIOThreadPool;
+
+// Owns a set of client sockets, frames whatever arrives on them right away and writes whatever the tick hands it
+class NetworkIOThread
+{
+public:
+    NetworkIOThread(NetworkIOThreadPool& pool) : _pool(pool), _commands(64), _pendingSends(256) { }
+
+    bool Start(NetworkIOBackend backend);
+    void Stop();
+
+    NetworkIOBackend GetBackend() const { return _backend; }
+
+    void Add(std::shared_ptr<NetworkChannel> channel);
+    void Remove(std::shared_ptr<NetworkChannel> channel);
+
+    // Called by the tick through NetworkChannel::Close(), the socket is closed here so it never goes away under one of our reads
+    void Close(NetworkChannel& channel);
+
+    // Called by the tick after it queued segments on the channel
+    void ScheduleSend(NetworkChannel& channel);
+
+    // Called by the tick once it released the packets of a channel whose reads were paused, the thread retries every paused channel when it wakes
+    void ScheduleResume() { Wake(); }
+
+    u32 GetNumChannels() const { return _numChannels; }
+
+private:
+    void Run();
+    void RunUring();
+    void Wake();
+
+    void HandleCommands();
+    void HandleRead(NetworkChannel& channel);
+    void HandlePausedReads();
+    void HandleWrite(NetworkChannel& channel);
+    void HandleSends();
+
+    // Watches the socket for writes while it has unsent data and for reads while they aren't paused, hangs the channel up if that fails
+    void UpdateInterest(NetworkChannel& channel);
+
+private:
+    struct Command
+    {
+        enum class Type : u8
+        {
+            ADD,
+            REMOVE,
+            CLOSE
+        };
+
+        std::shared_ptr<NetworkChannel> channel;
+        Type type;
+    };
+
+    NetworkIOThreadPool& _pool;
+    NetworkIOBackend _backend = NetworkIOBackend::EPOLL;
+    SocketReactor _reactor;
+    NetworkUring _uring;
+    std::thread _thread;
+
+    std::atomic<bool> _isRunning = { false };
+    std::atomic<bool> _isWakePending = { false };
+    std::atomic<u32> _numChannels = { 0 };
+
+    moodycamel::ConcurrentQueue<Command> _commands;
+    moodycamel::ConcurrentQueue<u64> _pendingSends;
+
+    // Only touched by the I/O thread itself
+    robin_hood::unordered_map<u64, std::shared_ptr<NetworkChannel>> _channels;
+    std::vector<u64> _readyTokens;
+    std::vector<u64> _writableTokens;
+    std::vector<PacketSegment> _sendScratch;
+
+    // Channels whose receive ring filled up, their sockets aren't watched for reads until the ring has room again
+    std::vector<u64> _pausedTokens;
+    std::vector<u64> _pausedScratch;
+};
+
+class NetworkIOThreadPool
+{
+public:
+    NetworkIOThreadPool() : _readyTokens(256) { }
+    ~NetworkIOThreadPool() { Stop(); }
+
+    // Fails when the platform has no reactor to block on, the tick then has to keep polling every socket
+    bool Start(u32 numThreads, NetworkIOBackend backend = NetworkIOBackend::EPOLL);
+    void Stop();
+
+    bool IsRunning() const { return _threads.size() > 0; }
+    u32 GetNumThreads() const { return static_cast<u32>(_threads.size()); }
+
+    // Every thread falls back the same way, so the first one speaks for all of them
+    NetworkIOBackend GetBackend() const { return IsRunning() ? _threads[0]->GetBackend() : NetworkIOBackend::EPOLL; }
+
+    // Hands the socket to the least loaded I/O thread
+    void Add(std::shared_ptr<NetworkChannel> channel);
+    void Remove(const std::shared_ptr<NetworkChannel>& channel);
+
+    // Tokens of every channel that has decoded packets waiting or was disconnected since the last call
+    void GetReadyTokens(std::vector<u64>& readyTokens);
+
+    // Called by the I/O threads
+    void QueueForTick(NetworkChannel& channel);
+
+private:
+    std::vector<std::unique_ptr<NetworkIOThread>> _threads;
+    moodycamel::ConcurrentQueue<u64> _readyTokens;
+};
\ No newline at end of file
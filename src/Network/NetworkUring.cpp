@@ -0,0 +1,602 @@
+#include "NetworkUring.h"
+#include "NetworkChannel.h"
+#include <Networking/NetClient.h>
+#include <Networking/NetSocket.h>
+#include <Utils/DebugHandler.h>
+
+#ifdef WORLD_IO_URING
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#endif
+
+NetworkUring::~NetworkUring()
+{
+#ifdef WORLD_IO_URING
+    // Cancels whatever is still in flight before the channels (and the memory it targets) go away
+    if (_isInitialized)
+    {
+        if (_bufferRing)
+        {
+            io_uring_free_buf_ring(&_ring, _bufferRing, NETWORK_URING_BUFFER_COUNT, NETWORK_URING_BUFFER_GROUP);
+        }
+
+        io_uring_queue_exit(&_ring);
+    }
+
+    if (_wakeFd >= 0)
+    {
+        close(_wakeFd);
+    }
+#endif
+}
+
+bool NetworkUring::Init()
+{
+#ifdef WORLD_IO_URING
+    io_uring_params params = {};
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = NETWORK_URING_CQ_ENTRIES;
+
+    i32 result = io_uring_queue_init_params(NETWORK_URING_ENTRIES, &_ring, &params);
+    if (result < 0)
+    {
+        DebugHandler::PrintWarning("[Network/Uring]: Failed to set up io_uring (%d), falling back to epoll", -result);
+        return false;
+    }
+
+    _isInitialized = true;
+
+    _wakeFd = eventfd(0, EFD_CLOEXEC);
+    if (_wakeFd < 0)
+    {
+        io_uring_queue_exit(&_ring);
+        _isInitialized = false;
+        return false;
+    }
+
+    if (!InitProvidedBuffers())
+    {
+        DebugHandler::PrintWarning("[Network/Uring]: Kernel doesn't support provided buffer rings, receiving straight into the receive rings");
+    }
+
+    ArmWake();
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool NetworkUring::IsAvailable() const
+{
+#ifdef WORLD_IO_URING
+    return _isInitialized;
+#else
+    return false;
+#endif
+}
+
+bool NetworkUring::HasProvidedBuffers() const
+{
+#ifdef WORLD_IO_URING
+    return _bufferRing != nullptr;
+#else
+    return false;
+#endif
+}
+
+void NetworkUring::Add(std::shared_ptr<NetworkChannel> channel)
+{
+#ifdef WORLD_IO_URING
+    u64 token = channel->token;
+
+    std::unique_ptr<ChannelState> state = std::make_unique<ChannelState>();
+    state->handle = static_cast<i32>(channel->netClient->GetSocket()->GetSocket());
+    state->receiveOp = { Operation::Type::RECEIVE, token };
+    state->sendOp = { Operation::Type::SEND, token };
+    state->channel = std::move(channel);
+
+    _channels[token] = std::move(state);
+    _armReceiveTokens.push_back(token);
+#endif
+}
+
+void NetworkUring::Remove(u64 token)
+{
+#ifdef WORLD_IO_URING
+    auto itr = _channels.find(token);
+    if (itr == _channels.end())
+        return;
+
+    ChannelState& state = *itr->second;
+    state.isRemoved = true;
+
+    CancelInFlight(state);
+    ReleaseIfIdle(token);
+#endif
+}
+
+void NetworkUring::Close(u64 token)
+{
+#ifdef WORLD_IO_URING
+    auto itr = _channels.find(token);
+    if (itr == _channels.end() || itr->second->isRemoved)
+        return;
+
+    // Completions still come in for what was in flight, they're dropped since the channel is no longer connected
+    CancelInFlight(*itr->second);
+#endif
+}
+
+void NetworkUring::Send(u64 token, std::shared_ptr<Bytebuffer> buffer)
+{
+#ifdef WORLD_IO_URING
+    auto itr = _channels.find(token);
+    if (itr == _channels.end() || itr->second->isRemoved || !itr->second->channel->IsConnected())
+        return;
+
+    ChannelState& state = *itr->second;
+    state.writes.push_back(std::move(buffer));
+
+    if (!state.isSending)
+    {
+        ArmSend(state);
+    }
+#endif
+}
+
+void NetworkUring::Wake()
+{
+#ifdef WORLD_IO_URING
+    u64 value = 1;
+    if (write(_wakeFd, &value, sizeof(value)) < 0)
+    {
+        DebugHandler::PrintWarning("[Network/Uring]: Failed to wake I/O thread");
+    }
+#endif
+}
+
+void NetworkUring::Submit(std::vector<u64>& readyTokens, i32 timeoutMS)
+{
+    readyTokens.clear();
+
+#ifdef WORLD_IO_URING
+    RetryDeferred(readyTokens);
+    ResumePausedReceives(readyTokens);
+
+    io_uring_submit(&_ring);
+
+    io_uring_cqe* cqe = nullptr;
+    __kernel_timespec timeout = {};
+    timeout.tv_sec = timeoutMS / 1000;
+    timeout.tv_nsec = static_cast<long long>(timeoutMS % 1000) * 1000000;
+
+    i32 result = io_uring_wait_cqe_timeout(&_ring, &cqe, &timeout);
+    if (result < 0 && result != -ETIME && result != -EINTR)
+    {
+        DebugHandler::PrintWarning("[Network/Uring]: Failed to wait for completions (%d)", -result);
+        return;
+    }
+
+    while (io_uring_peek_cqe(&_ring, &cqe) == 0)
+    {
+        Operation* operation = static_cast<Operation*>(io_uring_cqe_get_data(cqe));
+        i32 res = cqe->res;
+        u32 flags = cqe->flags;
+        io_uring_cqe_seen(&_ring, cqe);
+
+        // Cancel requests themselves
+        if (!operation)
+            continue;
+
+        if (operation->type == Operation::Type::WAKE)
+        {
+            _isWakeArmed = false;
+            ArmWake();
+            continue;
+        }
+
+        auto itr = _channels.find(operation->token);
+        if (itr == _channels.end())
+        {
+            if (flags & IORING_CQE_F_BUFFER)
+            {
+                RecycleBuffer(static_cast<u16>(flags >> IORING_CQE_BUFFER_SHIFT));
+            }
+
+            continue;
+        }
+
+        ChannelState& state = *itr->second;
+        if (operation->type == Operation::Type::RECEIVE)
+        {
+            state.isReceiving = false;
+            HandleReceive(state, res, flags, readyTokens);
+
+            // Its bytes were copied into the receive ring (or aren't wanted anymore), the kernel can fill it again
+            if (flags & IORING_CQE_F_BUFFER)
+            {
+                RecycleBuffer(static_cast<u16>(flags >> IORING_CQE_BUFFER_SHIFT));
+            }
+        }
+        else
+        {
+            state.isSending = false;
+            HandleSend(state, res, readyTokens);
+        }
+
+        if (state.isRemoved)
+        {
+            ReleaseIfIdle(operation->token);
+        }
+    }
+#endif
+}
+
+#ifdef WORLD_IO_URING
+io_uring_sqe* NetworkUring::GetSqe()
+{
+    io_uring_sqe* sqe = io_uring_get_sqe(&_ring);
+    if (!sqe)
+    {
+        // Submission queue is full, hand what we have to the kernel early
+        io_uring_submit(&_ring);
+        sqe = io_uring_get_sqe(&_ring);
+    }
+
+    return sqe;
+}
+
+void NetworkUring::ArmReceive(ChannelState& state, std::vector<u64>& readyTokens)
+{
+    NetworkChannel& channel = *state.channel;
+    if (!channel.IsConnected())
+    {
+        readyTokens.push_back(channel.token);
+        return;
+    }
+
+    ReceiveRing& ring = channel.PrepareReceiveRing();
+
+    // Same as NetworkChannel::Receive, the tick still holds everything in the ring so we stop reading and let TCP flow control hold the peer back
+    if (channel.isReadPaused || ring.GetSpace() == 0)
+    {
+        channel.isReadPaused = true;
+        _pausedTokens.push_back(channel.token);
+        return;
+    }
+
+    io_uring_sqe* sqe = GetSqe();
+    if (!sqe)
+    {
+        _armReceiveTokens.push_back(channel.token);
+        return;
+    }
+
+    if (_bufferRing)
+    {
+        // The kernel picks the buffer once data arrived, we never take more than the receive ring can hold
+        io_uring_prep_recv(sqe, state.handle, nullptr, std::min(ring.GetSpace(), static_cast<size_t>(NETWORK_URING_BUFFER_SIZE)), 0);
+        sqe->flags |= IOSQE_BUFFER_SELECT;
+        sqe->buf_group = NETWORK_URING_BUFFER_GROUP;
+    }
+    else
+    {
+        io_uring_prep_recv(sqe, state.handle, ring.GetWritePointer(), ring.GetContiguousSpace(), 0);
+    }
+
+    io_uring_sqe_set_data(sqe, &state.receiveOp);
+    state.isReceiving = true;
+}
+
+void NetworkUring::ResumePausedReceives(std::vector<u64>& readyTokens)
+{
+    if (_pausedTokens.empty())
+        return;
+
+    _pausedScratch.swap(_pausedTokens);
+
+    for (u64 token : _pausedScratch)
+    {
+        auto itr = _channels.find(token);
+        if (itr == _channels.end() || itr->second->isRemoved)
+            continue;
+
+        ChannelState& state = *itr->second;
+        NetworkChannel& channel = *state.channel;
+        if (!channel.IsConnected())
+        {
+            readyTokens.push_back(token);
+            continue;
+        }
+
+        // Takes back whatever the tick released and frames what was waiting for a slot, ArmReceive parks the channel again if that didn't make room
+        channel.PrepareReceiveRing();
+
+        u32 numPackets = 0;
+        if (!channel.Frame(numPackets))
+        {
+            Disconnect(state, readyTokens);
+            continue;
+        }
+
+        if (numPackets > 0)
+        {
+            readyTokens.push_back(token);
+        }
+
+        ArmReceive(state, readyTokens);
+    }
+
+    _pausedScratch.clear();
+}
+
+void NetworkUring::ArmSend(ChannelState& state)
+{
+    const std::shared_ptr<Bytebuffer>& buffer = state.writes.front();
+
+    io_uring_sqe* sqe = GetSqe();
+    if (!sqe)
+    {
+        _armSendTokens.push_back(state.channel->token);
+        return;
+    }
+
+    io_uring_prep_send(sqe, state.handle, buffer->GetDataPointer() + state.sendOffset, buffer->writtenData - state.sendOffset, MSG_NOSIGNAL);
+    io_uring_sqe_set_data(sqe, &state.sendOp);
+    state.isSending = true;
+}
+
+void NetworkUring::ArmWake()
+{
+    // Retried on the next Submit(), until then we only wake up on completions and the poll timeout
+    io_uring_sqe* sqe = GetSqe();
+    if (!sqe)
+        return;
+
+    io_uring_prep_read(sqe, _wakeFd, &_wakeValue, sizeof(_wakeValue), 0);
+    io_uring_sqe_set_data(sqe, &_wakeOp);
+    _isWakeArmed = true;
+}
+
+void NetworkUring::RetryDeferred(std::vector<u64>& readyTokens)
+{
+    if (!_isWakeArmed)
+    {
+        ArmWake();
+    }
+
+    // Each of these queues the channel again if the submission queue is still full
+    _deferredScratch.swap(_cancelTokens);
+    for (u64 token : _deferredScratch)
+    {
+        auto itr = _channels.find(token);
+        if (itr != _channels.end())
+        {
+            CancelInFlight(*itr->second);
+        }
+    }
+    _deferredScratch.clear();
+
+    _deferredScratch.swap(_armSendTokens);
+    for (u64 token : _deferredScratch)
+    {
+        auto itr = _channels.find(token);
+        if (itr == _channels.end())
+            continue;
+
+        ChannelState& state = *itr->second;
+        if (state.isRemoved || state.isSending || state.writes.empty() || !state.channel->IsConnected())
+            continue;
+
+        ArmSend(state);
+    }
+    _deferredScratch.clear();
+
+    _deferredScratch.swap(_armReceiveTokens);
+    for (u64 token : _deferredScratch)
+    {
+        auto itr = _channels.find(token);
+        if (itr == _channels.end())
+            continue;
+
+        ChannelState& state = *itr->second;
+        if (state.isRemoved || state.isReceiving)
+            continue;
+
+        ArmReceive(state, readyTokens);
+    }
+    _deferredScratch.clear();
+}
+
+bool NetworkUring::InitProvidedBuffers()
+{
+    i32 result = 0;
+    _bufferRing = io_uring_setup_buf_ring(&_ring, NETWORK_URING_BUFFER_COUNT, NETWORK_URING_BUFFER_GROUP, 0, &result);
+    if (!_bufferRing)
+        return false;
+
+    _bufferData = std::make_unique<u8[]>(static_cast<size_t>(NETWORK_URING_BUFFER_COUNT) * NETWORK_URING_BUFFER_SIZE);
+
+    i32 mask = io_uring_buf_ring_mask(NETWORK_URING_BUFFER_COUNT);
+    for (u32 i = 0; i < NETWORK_URING_BUFFER_COUNT; i++)
+    {
+        io_uring_buf_ring_add(_bufferRing, _bufferData.get() + (static_cast<size_t>(i) * NETWORK_URING_BUFFER_SIZE), NETWORK_URING_BUFFER_SIZE, static_cast<u16>(i), mask, static_cast<i32>(i));
+    }
+
+    io_uring_buf_ring_advance(_bufferRing, NETWORK_URING_BUFFER_COUNT);
+    return true;
+}
+
+void NetworkUring::RecycleBuffer(u16 bufferId)
+{
+    u8* buffer = _bufferData.get() + (static_cast<size_t>(bufferId) * NETWORK_URING_BUFFER_SIZE);
+
+    io_uring_buf_ring_add(_bufferRing, buffer, NETWORK_URING_BUFFER_SIZE, bufferId, io_uring_buf_ring_mask(NETWORK_URING_BUFFER_COUNT), 0);
+    io_uring_buf_ring_advance(_bufferRing, 1);
+}
+
+void NetworkUring::HandleReceive(ChannelState& state, i32 result, u32 flags, std::vector<u64>& readyTokens)
+{
+    if (state.isRemoved || !state.channel->IsConnected())
+        return;
+
+    if (result == -EAGAIN || result == -EINTR)
+    {
+        ArmReceive(state, readyTokens);
+        return;
+    }
+
+    // Every provided buffer is waiting to be recycled by this very loop, try again on the next Submit()
+    if (result == -ENOBUFS)
+    {
+        _armReceiveTokens.push_back(state.channel->token);
+        return;
+    }
+
+    // Hung up or errored
+    if (result <= 0)
+    {
+        Disconnect(state, readyTokens);
+        return;
+    }
+
+    NetworkChannel& channel = *state.channel;
+    ReceiveRing& ring = *channel.receiveRing;
+
+    if (flags & IORING_CQE_F_BUFFER)
+    {
+        // The receive was sized to the ring's free space, it only has to be split where the ring wraps
+        const u8* buffer = _bufferData.get() + (static_cast<size_t>(flags >> IORING_CQE_BUFFER_SHIFT) * NETWORK_URING_BUFFER_SIZE);
+
+        size_t size = static_cast<size_t>(result);
+        assert(size <= ring.GetSpace());
+
+        while (size > 0)
+        {
+            size_t copySize = std::min(size, ring.GetContiguousSpace());
+            std::memcpy(ring.GetWritePointer(), buffer, copySize);
+            ring.SkipWrite(copySize);
+
+            buffer += copySize;
+            size -= copySize;
+        }
+    }
+    else
+    {
+        ring.SkipWrite(static_cast<size_t>(result));
+    }
+
+    u32 numPackets = 0;
+    if (!channel.Frame(numPackets))
+    {
+        Disconnect(state, readyTokens);
+        return;
+    }
+
+    if (numPackets > 0)
+    {
+        readyTokens.push_back(channel.token);
+    }
+
+    ArmReceive(state, readyTokens);
+}
+
+void NetworkUring::HandleSend(ChannelState& state, i32 result, std::vector<u64>& readyTokens)
+{
+    // The kernel is done with the write in flight, whatever is left will never be sent
+    if (state.isRemoved || !state.channel->IsConnected())
+    {
+        state.writes.clear();
+        state.sendOffset = 0;
+        return;
+    }
+
+    if (result == -EAGAIN || result == -EINTR)
+    {
+        ArmSend(state);
+        return;
+    }
+
+    if (result < 0)
+    {
+        Disconnect(state, readyTokens);
+        return;
+    }
+
+    // Stream sockets may take less than we asked for, the rest goes before anything else queued
+    state.sendOffset += static_cast<size_t>(result);
+
+    size_t size = state.writes.front()->writtenData;
+    if (state.sendOffset < size)
+    {
+        ArmSend(state);
+        return;
+    }
+
+    state.channel->pendingSendBytes -= size;
+    state.writes.pop_front();
+    state.sendOffset = 0;
+
+    if (state.writes.size() > 0)
+    {
+        ArmSend(state);
+    }
+}
+
+void NetworkUring::Disconnect(ChannelState& state, std::vector<u64>& readyTokens)
+{
+    NetworkChannel& channel = *state.channel;
+    channel.HangUp();
+
+    // The socket stays open until the tick drops the channel, which removes it from here and closes it
+    // Nothing is armed again, and the kernel holds its own reference to the socket so closing it wouldn't end what's in flight anyway
+    CancelInFlight(state);
+    readyTokens.push_back(channel.token);
+}
+
+void NetworkUring::CancelInFlight(ChannelState& state)
+{
+    // A write the kernel may still be reading stays queued until its completion arrives
+    if (!state.isSending)
+    {
+        state.writes.clear();
+        state.sendOffset = 0;
+    }
+
+    // Completions of cancelled ops carry no data, they only tell us the kernel let go of the memory
+    Operation* inFlight[] = { state.isReceiving ? &state.receiveOp : nullptr, state.isSending ? &state.sendOp : nullptr };
+    for (Operation* operation : inFlight)
+    {
+        if (!operation)
+            continue;
+
+        // Both are cancelled again on the next Submit(), cancelling one that's already gone is harmless
+        io_uring_sqe* sqe = GetSqe();
+        if (!sqe)
+        {
+            _cancelTokens.push_back(state.channel->token);
+            return;
+        }
+
+        io_uring_prep_cancel(sqe, operation, 0);
+        io_uring_sqe_set_data(sqe, nullptr);
+    }
+}
+
+void NetworkUring::ReleaseIfIdle(u64 token)
+{
+    auto itr = _channels.find(token);
+    if (itr == _channels.end())
+        return;
+
+    ChannelState& state = *itr->second;
+    if (state.isReceiving || state.isSending)
+        return;
+
+    _channels.erase(itr);
+}
+#endif
\ No newline at end of file
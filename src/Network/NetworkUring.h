@@ -0,0 +1,140 @@
+#pragma once
+#include <NovusTypes.h>
+#include <Utils/ByteBuffer.h>
+#include <robin_hood.h>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#ifdef WORLD_IO_URING
+#include <liburing.h>
+#endif
+
+// Submission queue size, every channel has at most one receive and one send in flight
+#define NETWORK_URING_ENTRIES 4096
+
+// Completion queue size, large enough for every op of every channel a single I/O thread can own
+#define NETWORK_URING_CQ_ENTRIES 32768
+
+// Provided buffer ring shared by every receive of an I/O thread, the kernel only picks a buffer once data arrived so idle connections pin none
+// Needs a 5.19 kernel, older ones receive straight into the channel's receive ring instead
+// NETWORK_URING_BUFFER_COUNT has to be a power of two
+#define NETWORK_URING_BUFFER_COUNT 1024
+#define NETWORK_URING_BUFFER_SIZE 4096
+#define NETWORK_URING_BUFFER_GROUP 0
+
+struct NetworkChannel;
+
+// io_uring backend for a network I/O thread, only compiled in with WORLD_IO_URING (Linux only), IsAvailable() returns false otherwise
+// Receives land in a provided buffer and are copied into the channel's receive ring where they're framed in place, writes to a channel are issued one at a time so they can't reorder
+// Everything queued between two calls to Submit() goes to the kernel in a single submission
+// Whatever didn't fit the submission queue (see GetSqe()) is queued again on the next Submit()
+class NetworkUring
+{
+public:
+    NetworkUring() { }
+    ~NetworkUring();
+
+    NetworkUring(const NetworkUring&) = delete;
+    NetworkUring& operator=(const NetworkUring&) = delete;
+
+    // Fails if we were built without io_uring or the kernel doesn't support it, callers should fall back to SocketReactor
+    bool Init();
+    bool IsAvailable() const;
+    bool HasProvidedBuffers() const;
+
+    // Starts receiving, the channel is kept alive until the kernel is done with it
+    void Add(std::shared_ptr<NetworkChannel> channel);
+    void Remove(u64 token);
+
+    // Stops everything in flight for a channel the tick wants closed, the caller closes the NetClient right after
+    void Close(u64 token);
+
+    // The buffer is held until the kernel has written it, pendingSendBytes on the channel is only released then
+    void Send(u64 token, std::shared_ptr<Bytebuffer> buffer);
+
+    // Interrupts a Submit() waiting for completions, from any thread
+    void Wake();
+
+    // Submits everything queued since the last call and handles completions, waits at most timeoutMS if there are none
+    // Fills readyTokens with every channel that framed packets or was disconnected
+    void Submit(std::vector<u64>& readyTokens, i32 timeoutMS);
+
+#ifdef WORLD_IO_URING
+private:
+    struct Operation
+    {
+        enum class Type : u8
+        {
+            RECEIVE,
+            SEND,
+            WAKE
+        };
+
+        Type type;
+        u64 token;
+    };
+
+    struct ChannelState
+    {
+        std::shared_ptr<NetworkChannel> channel;
+        i32 handle;
+
+        Operation receiveOp;
+        Operation sendOp;
+        bool isReceiving = false;
+        bool isSending = false;
+        bool isRemoved = false;
+
+        // Front is the write in flight, sendOffset is how much of it the kernel already took
+        std::deque<std::shared_ptr<Bytebuffer>> writes;
+        size_t sendOffset = 0;
+    };
+
+    // Null if the submission queue is full and handing it to the kernel early failed too, callers queue what they wanted to do for the next Submit()
+    io_uring_sqe* GetSqe();
+
+    void ArmReceive(ChannelState& state, std::vector<u64>& readyTokens);
+    void ResumePausedReceives(std::vector<u64>& readyTokens);
+    void ArmSend(ChannelState& state);
+    void ArmWake();
+    void RetryDeferred(std::vector<u64>& readyTokens);
+
+    bool InitProvidedBuffers();
+    void RecycleBuffer(u16 bufferId);
+
+    void HandleReceive(ChannelState& state, i32 result, u32 flags, std::vector<u64>& readyTokens);
+    void HandleSend(ChannelState& state, i32 result, std::vector<u64>& readyTokens);
+    void Disconnect(ChannelState& state, std::vector<u64>& readyTokens);
+    void CancelInFlight(ChannelState& state);
+
+    // Releases the channel once nothing is in flight anymore
+    void ReleaseIfIdle(u64 token);
+
+private:
+    io_uring _ring;
+    bool _isInitialized = false;
+
+    i32 _wakeFd = -1;
+    u64 _wakeValue = 0;
+    Operation _wakeOp = { Operation::Type::WAKE, 0 };
+    bool _isWakeArmed = false;
+
+    io_uring_buf_ring* _bufferRing = nullptr;
+    std::unique_ptr<u8[]> _bufferData;
+
+    robin_hood::unordered_map<u64, std::unique_ptr<ChannelState>> _channels;
+
+    // Channels that need a receive armed on the next Submit(), newly added ones and ones we couldn't get an SQE or a provided buffer for
+    std::vector<u64> _armReceiveTokens;
+
+    // Channels whose send or cancel didn't fit the submission queue
+    std::vector<u64> _armSendTokens;
+    std::vector<u64> _cancelTokens;
+    std::vector<u64> _deferredScratch;
+
+    // Channels whose receive ring filled up, no receive is armed for them until the ring has room again
+    std::vector<u64> _pausedTokens;
+    std::vector<u64> _pausedScratch;
+#endif
+};
\ No newline at end of file
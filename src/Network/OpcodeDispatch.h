@@ -0,0 +1,94 @@
+#pragma once
+#include <NovusTypes.h>
+#include <Networking/NetPacket.h>
+#include <Networking/NetClient.h>
+#include <Utils/DebugHandler.h>
+
+// Payload of opcodes that carry nothing
+struct EmptyPayload
+{
+    bool Read(NetPacket& /*packet*/) { return true; }
+};
+
+// Adapts the NetStructures types that deserialize themselves
+template <typename T>
+struct DeserializedPayload
+{
+    T value;
+
+    bool Read(NetPacket& packet)
+    {
+        value.Deserialize(packet.payload);
+        return true;
+    }
+};
+
+// A handler bound to its opcode at compile time
+// The connection status and payload size are checked and Payload::Read(NetPacket&) has decoded the payload before Handler is called,
+// both the connection and the payload are borrowed for the duration of the call
+template <Opcode InOpcode, ConnectionStatus Status, u16 MinSize, u16 MaxSize, typename Payload, bool (*Handler)(NetClient&, Payload&)>
+struct OpcodeHandler
+{
+    static constexpr Opcode opcode = InOpcode;
+
+    static bool Call(NetClient& netClient, NetPacket& packet)
+    {
+        if (netClient.GetConnectionStatus() != Status)
+            return false;
+
+        if (packet.header.size < MinSize || packet.header.size > MaxSize)
+            return false;
+
+        Payload payload;
+        if (!payload.Read(packet))
+            return false;
+
+        return Handler(netClient, payload);
+    }
+};
+
+// Fixed size opcodes
+template <Opcode InOpcode, ConnectionStatus Status, typename Payload, bool (*Handler)(NetClient&, Payload&), u16 Size = sizeof(Payload)>
+using FixedOpcodeHandler = OpcodeHandler<InOpcode, Status, Size, Size, Payload, Handler>;
+
+// Dispatches to the handler registered for the packet's opcode, every call is direct so hot handlers can be inlined into the dispatch
+// Returns false if the opcode has no handler or the handler rejected the packet
+template <typename... Handlers>
+class OpcodeDispatchTable
+{
+public:
+    static bool Dispatch(NetClient& netClient, NetPacket& packet)
+    {
+        const Opcode opcode = packet.header.opcode;
+
+        bool result = false;
+        bool isHandled = ((opcode == Handlers::opcode && (result = Handlers::Call(netClient, packet), true)) || ...);
+
+#ifdef NC_Debug
+        if (!isHandled)
+        {
+            DebugHandler::PrintWarning("[Network/Dispatch]: No handler for opcode (%u)", static_cast<u16>(opcode));
+        }
+#endif // NC_Debug
+
+        return isHandled && result;
+    }
+
+private:
+    static constexpr bool HasUniqueOpcodes()
+    {
+        constexpr Opcode opcodes[] = { Handlers::opcode... };
+        for (size_t i = 0; i < sizeof...(Handlers); i++)
+        {
+            for (size_t j = i + 1; j < sizeof...(Handlers); j++)
+            {
+                if (opcodes[i] == opcodes[j])
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    static_assert(HasUniqueOpcodes(), "An opcode can only have one handler");
+};
@@ -0,0 +1,208 @@
+#pragma once
+#include <NovusTypes.h>
+#include <Utils/ByteBuffer.h>
+#include <Networking/NetPacket.h>
+#include <Networking/NetClient.h>
+#include <robin_hood.h>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#define PACKET_WRITE_BUFFER_SIZE 8192
+
+// A serialized packet that is never written to again, every connection it is sent to shares the same buffer
+class PacketSegment
+{
+public:
+    PacketSegment() { }
+    explicit PacketSegment(std::shared_ptr<Bytebuffer> buffer) : _buffer(std::move(buffer)) { }
+
+    bool IsEmpty() const { return _buffer == nullptr; }
+    const u8* GetData() const { return _buffer->GetDataPointer(); }
+    size_t GetSize() const { return _buffer ? _buffer->writtenData : 0; }
+
+    const std::shared_ptr<Bytebuffer>& GetBuffer() const { return _buffer; }
+
+private:
+    std::shared_ptr<Bytebuffer> _buffer = nullptr;
+};
+
+struct QueuedSegment
+{
+    PacketSegment segment;
+    f32 queuedTime = -1.0f; // Stamped by the send scheduler the first tick it sees the segment
+    u64 supersedeKey = 0; // Segments sharing a non zero key carry state where only the newest matters, emptied once superseded
+};
+
+// Holds references to the segments queued for a single connection, nothing is copied until the queue is flushed
+struct PacketSendQueue
+{
+    std::vector<QueuedSegment> segments;
+    size_t queuedBytes = 0;
+
+    // Segments dropped because a newer one with the same key was pushed while they were waiting
+    u64 numCollapsed = 0;
+
+    // Keys of the opcodes that may be collapsed, the id is whatever the state belongs to (usually an entity)
+    static u64 GetSupersedeKey(Opcode opcode, u32 id) { return (static_cast<u64>(opcode) << 32) | id; }
+
+    bool IsEmpty() const { return segments.size() == 0; }
+
+    // The newest segment keeps its place at the back, so it still follows everything that was queued before it
+    void Push(const PacketSegment& segment, u64 supersedeKey = 0)
+    {
+        if (supersedeKey != 0)
+        {
+            auto itr = _keyToIndex.find(supersedeKey);
+            if (itr != _keyToIndex.end())
+            {
+                QueuedSegment& superseded = segments[itr->second];
+                queuedBytes -= superseded.segment.GetSize();
+                superseded.segment = PacketSegment();
+                numCollapsed++;
+
+                itr->second = segments.size();
+            }
+            else
+            {
+                _keyToIndex[supersedeKey] = segments.size();
+            }
+        }
+
+        segments.push_back({ segment, -1.0f, supersedeKey });
+        queuedBytes += segment.GetSize();
+    }
+
+    void Clear()
+    {
+        segments.clear();
+        _keyToIndex.clear();
+        queuedBytes = 0;
+    }
+
+    // Unstamped segments are always at the back of the queue
+    void Stamp(f32 time)
+    {
+        for (auto itr = segments.rbegin(); itr != segments.rend() && itr->queuedTime < 0.0f; itr++)
+        {
+            itr->queuedTime = time;
+        }
+    }
+
+    f32 GetOldestQueuedTime() const { return segments.size() > 0 ? segments.front().queuedTime : -1.0f; }
+
+    // Drops every segment queued before time, returns the number of bytes dropped
+    size_t DropQueuedBefore(f32 time)
+    {
+        auto itr = segments.begin();
+        size_t droppedBytes = 0;
+
+        while (itr != segments.end() && itr->queuedTime >= 0.0f && itr->queuedTime < time)
+        {
+            droppedBytes += itr->segment.GetSize();
+            itr++;
+        }
+
+        if (itr == segments.begin())
+            return 0;
+
+        segments.erase(segments.begin(), itr);
+        queuedBytes -= droppedBytes;
+
+        // Every index moved, this only happens to stale low priority data so rebuilding is fine
+        _keyToIndex.clear();
+        for (size_t i = 0; i < segments.size(); i++)
+        {
+            if (segments[i].supersedeKey != 0 && !segments[i].segment.IsEmpty())
+                _keyToIndex[segments[i].supersedeKey] = i;
+        }
+
+        return droppedBytes;
+    }
+
+private:
+    robin_hood::unordered_map<u64, size_t> _keyToIndex;
+};
+
+// Packs the segments of any number of queues into as few writes as possible, a lone segment is sent without being copied
+// Sink only needs Send(std::shared_ptr<Bytebuffer>), it may hold on to the buffer since a write buffer is never reused once sent
+template <typename Sink>
+class BasicPacketCoalescer
+{
+public:
+    BasicPacketCoalescer(Sink& sink) : _sink(sink) { }
+    ~BasicPacketCoalescer() { Finish(); }
+
+    // Takes every segment out of the queue
+    void Add(PacketSendQueue& sendQueue)
+    {
+        for (const QueuedSegment& queuedSegment : sendQueue.segments)
+        {
+            if (!queuedSegment.segment.IsEmpty())
+                Add(queuedSegment.segment);
+        }
+
+        sendQueue.Clear();
+    }
+
+    void Add(const PacketSegment& segment)
+    {
+        if (!_pendingSegment.GetBuffer() && (!_writeBuffer || _writeBuffer->writtenData == 0))
+        {
+            _pendingSegment = segment;
+            return;
+        }
+
+        if (!_writeBuffer)
+            _writeBuffer = Bytebuffer::Borrow<PACKET_WRITE_BUFFER_SIZE>();
+
+        if (_pendingSegment.GetBuffer())
+        {
+            Append(_pendingSegment);
+            _pendingSegment = PacketSegment();
+        }
+
+        Append(segment);
+    }
+
+    // Sends whatever is left, returns the number of writes issued
+    u32 Finish()
+    {
+        if (_pendingSegment.GetBuffer())
+        {
+            _sink.Send(_pendingSegment.GetBuffer());
+            _pendingSegment = PacketSegment();
+            _numWrites++;
+        }
+        else if (_writeBuffer && _writeBuffer->writtenData)
+        {
+            _sink.Send(std::move(_writeBuffer));
+            _writeBuffer = nullptr;
+            _numWrites++;
+        }
+
+        return _numWrites;
+    }
+
+private:
+    void Append(const PacketSegment& segment)
+    {
+        if (_writeBuffer->GetSpace() < segment.GetSize())
+        {
+            _sink.Send(std::move(_writeBuffer));
+            _writeBuffer = Bytebuffer::Borrow<PACKET_WRITE_BUFFER_SIZE>();
+            _numWrites++;
+        }
+
+        std::memcpy(_writeBuffer->GetWritePointer(), segment.GetData(), segment.GetSize());
+        _writeBuffer->writtenData += segment.GetSize();
+    }
+
+private:
+    Sink& _sink;
+    PacketSegment _pendingSegment;
+    std::shared_ptr<Bytebuffer> _writeBuffer = nullptr;
+    u32 _numWrites = 0;
+};
+
+using PacketCoalescer = BasicPacketCoalescer<NetClient>;
\ No newline at end of file
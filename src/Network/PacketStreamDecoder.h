@@ -0,0 +1,58 @@
+#pragma once
+#include <NovusTypes.h>
+#include <Networking/NetPacket.h>
+#include "InternalOpcodes.h"
+
+enum class PacketStreamResult
+{
+    NEED_MORE_DATA,     // Everything complete has been decoded
+    SINK_FULL,          // The sink refused a complete packet
+    INVALID_OPCODE,
+    INVALID_SIZE
+};
+
+// Splits a byte stream into packets, shared by every link so framing is optimized (and measured) in one place
+//
+// Source has to provide:
+//   size_t GetActiveSize() const               - bytes received but not consumed yet
+//   void Peek(void* destination, size_t size)  - copies from the read position without consuming
+//
+// Sink is called as bool(const PacketHeader& header) for every complete packet, it has to consume
+// sizeof(PacketHeader) + header.size bytes from the source or return false to stop decoding
+//
+// Only the internal link to the auth server may use AcceptInternalOpcodes, clients sending an internal opcode are disconnected like for any other invalid one
+template <u16 MaxPayloadSize, bool AcceptInternalOpcodes = false>
+class PacketStreamDecoder
+{
+public:
+    template <typename Source, typename Sink>
+    static PacketStreamResult Decode(Source& source, Sink&& sink, u32& numPackets)
+    {
+        while (true)
+        {
+            size_t activeSize = source.GetActiveSize();
+
+            // We have received a partial header and need to read more
+            if (activeSize < sizeof(PacketHeader))
+                return PacketStreamResult::NEED_MORE_DATA;
+
+            PacketHeader header;
+            source.Peek(&header, sizeof(PacketHeader));
+
+            if (header.opcode == Opcode::INVALID || (header.opcode > Opcode::MAX_COUNT && !(AcceptInternalOpcodes && InternalOpcode::IsInternal(header.opcode))))
+                return PacketStreamResult::INVALID_OPCODE;
+
+            if (header.size > MaxPayloadSize)
+                return PacketStreamResult::INVALID_SIZE;
+
+            // We have received a valid header, but we have yet to receive the entire payload
+            if (activeSize - sizeof(PacketHeader) < header.size)
+                return PacketStreamResult::NEED_MORE_DATA;
+
+            if (!sink(header))
+                return PacketStreamResult::SINK_FULL;
+
+            numPackets++;
+        }
+    }
+};
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "PayloadPool.h"
+
+PayloadPoolStats PayloadPool::_stats[PAYLOAD_POOL_NUM_CLASSES];
+
+std::shared_ptr<Bytebuffer> PayloadPool::Borrow(size_t size)
+{
+    u32 sizeClass = GetClass(size);
+
+    std::shared_ptr<Bytebuffer> buffer = nullptr;
+    switch (sizeClass)
+    {
+        case 0: buffer = Bytebuffer::Borrow<CLASS_SIZES[0]>(); break;
+        case 1: buffer = Bytebuffer::Borrow<CLASS_SIZES[1]>(); break;
+        case 2: buffer = Bytebuffer::Borrow<CLASS_SIZES[2]>(); break;
+        case 3: buffer = Bytebuffer::Borrow<CLASS_SIZES[3]>(); break;
+        default: return nullptr;
+    }
+
+    PayloadPoolStats& stats = _stats[sizeClass];
+    stats.numBorrowed++;
+
+    u64 numInUse = ++stats.numInUse;
+    u64 peakInUse = stats.peakInUse;
+    while (numInUse > peakInUse && !stats.peakInUse.compare_exchange_weak(peakInUse, numInUse)) { }
+
+    // The pooled buffer goes back to its pool once the last reference to this one is gone
+    Bytebuffer* rawBuffer = buffer.get();
+    return std::shared_ptr<Bytebuffer>(rawBuffer, [buffer = std::move(buffer), &stats](Bytebuffer*) mutable
+    {
+        stats.numInUse--;
+        buffer.reset();
+    });
+}
+
+u32 PayloadPool::GetClass(size_t size)
+{
+    for (u32 i = 0; i < PAYLOAD_POOL_NUM_CLASSES; i++)
+    {
+        if (size <= CLASS_SIZES[i])
+            return i;
+    }
+
+    return PAYLOAD_POOL_NUM_CLASSES;
+}
\ No newline at end of file
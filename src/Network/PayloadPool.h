@@ -0,0 +1,30 @@
+#pragma once
+#include <NovusTypes.h>
+#include <Utils/ByteBuffer.h>
+#include <atomic>
+#include <memory>
+
+// Inbound payloads are borrowed from the smallest of these that fits instead of always taking a NETWORK_BUFFER_SIZE buffer
+#define PAYLOAD_POOL_NUM_CLASSES 4
+
+struct PayloadPoolStats
+{
+    std::atomic<u64> numBorrowed = { 0 };
+    std::atomic<u64> numInUse = { 0 };
+    std::atomic<u64> peakInUse = { 0 };
+};
+
+class PayloadPool
+{
+public:
+    static constexpr size_t CLASS_SIZES[PAYLOAD_POOL_NUM_CLASSES] = { 64, 256, 1024, 8192 };
+
+    // Returns nullptr if size is larger than the largest class
+    static std::shared_ptr<Bytebuffer> Borrow(size_t size);
+
+    static u32 GetClass(size_t size);
+    static const PayloadPoolStats& GetStats(u32 sizeClass) { return _stats[sizeClass]; }
+
+private:
+    static PayloadPoolStats _stats[PAYLOAD_POOL_NUM_CLASSES];
+};
\ No newline at end of file
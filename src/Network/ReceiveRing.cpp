@@ -0,0 +1,104 @@
+#include "ReceiveRing.h"
+#include "PayloadPool.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+// The control block std::allocate_shared puts in front of the packet holds a vtable pointer, both counts and the allocator
+static_assert(sizeof(NetPacket) + sizeof(ReceiveRingAllocator<NetPacket>) + 32 <= RECEIVE_RING_PACKET_STORAGE_SIZE, "RECEIVE_RING_PACKET_STORAGE_SIZE is too small to hold a NetPacket");
+static_assert(sizeof(Bytebuffer*) + sizeof(ReceiveRingAllocator<Bytebuffer>) + 32 <= RECEIVE_RING_PAYLOAD_STORAGE_SIZE, "RECEIVE_RING_PAYLOAD_STORAGE_SIZE is too small to hold a payload view");
+
+ReceiveRing::ReceiveRing(size_t size, u32 maxPackets) : _size(size), _maxPackets(maxPackets), _data(new u8[size]), _slots(std::make_unique<Slot[]>(maxPackets))
+{
+}
+
+void ReceiveRing::Reclaim()
+{
+    while (_slotTail < _slotHead)
+    {
+        Slot& slot = _slots[_slotTail % _maxPackets];
+        if (!slot.isReleased.load(std::memory_order_acquire))
+            break;
+
+        _reclaimedOffset = slot.endOffset;
+        _slotTail++;
+    }
+}
+
+size_t ReceiveRing::GetContiguousSpace() const
+{
+    size_t writeIndex = static_cast<size_t>(_writeOffset % _size);
+    return std::min(GetSpace(), _size - writeIndex);
+}
+
+void ReceiveRing::Peek(void* destination, size_t size) const
+{
+    size_t readIndex = static_cast<size_t>(_readOffset % _size);
+    size_t firstPart = std::min(size, _size - readIndex);
+
+    std::memcpy(destination, _data.get() + readIndex, firstPart);
+    std::memcpy(static_cast<u8*>(destination) + firstPart, _data.get(), size - firstPart);
+}
+
+void ReceiveRing::MoveUnreadTo(ReceiveRing& ring) const
+{
+    size_t size = GetActiveSize();
+    assert(ring.GetActiveSize() == 0 && size <= ring.GetContiguousSpace());
+
+    Peek(ring.GetWritePointer(), size);
+    ring.SkipWrite(size);
+}
+
+std::shared_ptr<NetPacket> ReceiveRing::Frame(const PacketHeader& header)
+{
+    u32 slotIndex = static_cast<u32>(_slotHead % _maxPackets);
+    Slot& slot = _slots[slotIndex];
+
+    _readOffset += sizeof(PacketHeader);
+    size_t payloadIndex = static_cast<size_t>(_readOffset % _size);
+
+    std::shared_ptr<Bytebuffer> payload = nullptr;
+    slot.numOwners.store(1, std::memory_order_relaxed);
+    slot.isReleased.store(false, std::memory_order_relaxed);
+
+    if (header.size)
+    {
+        if (payloadIndex + header.size <= _size)
+        {
+            Bytebuffer* view = new (&slot.payload) Bytebuffer(_data.get() + payloadIndex, header.size);
+            view->writtenData = header.size;
+
+            // The view is the slot's second owner, a handler holding on to the payload keeps the bytes (and the ring) alive after the packet is gone
+            slot.numOwners.store(2, std::memory_order_relaxed);
+            payload = std::shared_ptr<Bytebuffer>(view, PayloadViewDeleter(), ReceiveRingAllocator<Bytebuffer>(shared_from_this(), slotIndex, true));
+        }
+        else
+        {
+            // Wraps around the end of the ring, the only case that needs a contiguous copy
+            payload = PayloadPool::Borrow(header.size);
+            payload->size = header.size;
+            payload->writtenData = header.size;
+            Peek(payload->GetDataPointer(), header.size);
+        }
+    }
+
+    _readOffset += header.size;
+
+    slot.endOffset = _readOffset;
+    _slotHead++;
+
+    std::shared_ptr<NetPacket> packet = std::allocate_shared<NetPacket>(ReceiveRingAllocator<NetPacket>(shared_from_this(), slotIndex, false));
+    packet->header = header;
+    packet->payload = std::move(payload);
+
+    return packet;
+}
+
+void ReceiveRing::Release(u32 slotIndex)
+{
+    Slot& slot = _slots[slotIndex];
+    if (slot.numOwners.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        return;
+
+    slot.isReleased.store(true, std::memory_order_release);
+}
\ No newline at end of file
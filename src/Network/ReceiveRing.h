@@ -0,0 +1,129 @@
+#pragma once
+#include <NovusTypes.h>
+#include <Utils/ByteBuffer.h>
+#include <Networking/NetPacket.h>
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <type_traits>
+
+#define RECEIVE_RING_SIZE (16 * 1024)
+#define RECEIVE_RING_MAX_PACKETS 256
+#define RECEIVE_RING_MAX_PAYLOAD_SIZE 8192
+
+// Unauthenticated connections only ever send the logon challenge and handshake, they get a ring just big enough for those
+#define RECEIVE_RING_HANDSHAKE_SIZE 1024
+#define RECEIVE_RING_HANDSHAKE_MAX_PACKETS 4
+
+// Room for the shared_ptr control block with the NetPacket inside it
+#define RECEIVE_RING_PACKET_STORAGE_SIZE 96
+
+// Room for the control block of a payload view, it holds the view pointer, the deleter and the allocator
+#define RECEIVE_RING_PAYLOAD_STORAGE_SIZE 80
+
+// The receive buffer of a single connection, packets are framed from it in place and never compacted
+// Every framed packet occupies a slot until it is released, the bytes it covers are only reused once every packet before it has been released too
+// A packet whose payload wraps around the end of the ring is the only thing that gets copied
+class ReceiveRing : public std::enable_shared_from_this<ReceiveRing>
+{
+public:
+    ReceiveRing(size_t size = RECEIVE_RING_SIZE, u32 maxPackets = RECEIVE_RING_MAX_PACKETS);
+
+    // Takes back the space of every packet released (in order) since the last call, only called by the reader
+    void Reclaim();
+
+    u8* GetWritePointer() { return _data.get() + (_writeOffset % _size); }
+    size_t GetContiguousSpace() const;
+    size_t GetSpace() const { return _size - static_cast<size_t>(_writeOffset - _reclaimedOffset); }
+    void SkipWrite(size_t size) { _writeOffset += size; }
+
+    size_t GetSize() const { return _size; }
+    size_t GetActiveSize() const { return static_cast<size_t>(_writeOffset - _readOffset); }
+    bool HasFreeSlot() const { return _slotHead - _slotTail < _maxPackets; }
+
+    // Copies whatever hasn't been framed yet to the start of an empty ring, packets already framed keep this ring alive until they're released
+    void MoveUnreadTo(ReceiveRing& ring) const;
+
+    // Copies from the read position without consuming anything, headers spanning the wrap point are read in two parts
+    void Peek(void* destination, size_t size) const;
+
+    // Consumes the packet at the read position, the payload is a view into the ring unless it wraps
+    // A view owns its slot just like the packet does, the slot is released once both are gone
+    std::shared_ptr<NetPacket> Frame(const PacketHeader& header);
+
+private:
+    template <typename T>
+    friend struct ReceiveRingAllocator;
+
+    struct Slot
+    {
+        alignas(std::max_align_t) u8 packetStorage[RECEIVE_RING_PACKET_STORAGE_SIZE];
+        alignas(std::max_align_t) u8 payloadStorage[RECEIVE_RING_PAYLOAD_STORAGE_SIZE];
+        std::aligned_storage_t<sizeof(Bytebuffer), alignof(Bytebuffer)> payload;
+        u64 endOffset = 0;
+        std::atomic<u32> numOwners = { 0 };
+        std::atomic<bool> isReleased = { true };
+    };
+
+    // Destroys the view placed in the slot, the memory itself goes back through ReceiveRingAllocator
+    struct PayloadViewDeleter
+    {
+        void operator()(Bytebuffer* view) const { view->~Bytebuffer(); }
+    };
+
+    void Release(u32 slotIndex);
+
+private:
+    size_t _size;
+    u32 _maxPackets;
+    std::unique_ptr<u8[]> _data;
+
+    // Monotonic, the position in _data is offset % _size
+    u64 _writeOffset = 0;
+    u64 _readOffset = 0;
+    u64 _reclaimedOffset = 0;
+
+    u64 _slotHead = 0;
+    u64 _slotTail = 0;
+    std::unique_ptr<Slot[]> _slots;
+};
+
+// Places a control block (the packet's, or the payload view's) in a ring slot, giving the memory back drops that owner of the slot
+template <typename T>
+struct ReceiveRingAllocator
+{
+    using value_type = T;
+
+    ReceiveRingAllocator(std::shared_ptr<ReceiveRing> inRing, u32 inSlotIndex, bool inIsPayload) : ring(std::move(inRing)), slotIndex(inSlotIndex), isPayload(inIsPayload) { }
+
+    template <typename U>
+    ReceiveRingAllocator(const ReceiveRingAllocator<U>& other) : ring(other.ring), slotIndex(other.slotIndex), isPayload(other.isPayload) { }
+
+    T* allocate(size_t count)
+    {
+        ReceiveRing::Slot& slot = ring->_slots[slotIndex];
+        if (isPayload)
+        {
+            assert(count * sizeof(T) <= RECEIVE_RING_PAYLOAD_STORAGE_SIZE);
+            return reinterpret_cast<T*>(slot.payloadStorage);
+        }
+
+        assert(count * sizeof(T) <= RECEIVE_RING_PACKET_STORAGE_SIZE);
+        return reinterpret_cast<T*>(slot.packetStorage);
+    }
+
+    void deallocate(T* /*pointer*/, size_t /*count*/)
+    {
+        ring->Release(slotIndex);
+    }
+
+    template <typename U>
+    bool operator==(const ReceiveRingAllocator<U>& other) const { return ring == other.ring && slotIndex == other.slotIndex && isPayload == other.isPayload; }
+
+    template <typename U>
+    bool operator!=(const ReceiveRingAllocator<U>& other) const { return !(*this == other); }
+
+    std::shared_ptr<ReceiveRing> ring;
+    u32 slotIndex;
+    bool isPayload;
+};
\ No newline at end of file
@@ -0,0 +1,248 @@
+#include "SocketReactor.h"
+#include <Networking/NetSocket.h>
+#include <Utils/DebugHandler.h>
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+#define SOCKET_REACTOR_MAX_EVENTS 1024
+
+SocketReactor::SocketReactor()
+{
+#ifdef __linux__
+    _epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epollFd < 0)
+    {
+        DebugHandler::PrintWarning("[Network/Reactor]: Failed to create epoll instance, falling back to polling every socket");
+    }
+
+    _events.resize(SOCKET_REACTOR_MAX_EVENTS);
+#endif
+}
+
+SocketReactor::~SocketReactor()
+{
+#ifdef __linux__
+    if (_wakeFd >= 0)
+    {
+        close(_wakeFd);
+    }
+
+    if (_epollFd >= 0)
+    {
+        close(_epollFd);
+    }
+#endif
+}
+
+bool SocketReactor::IsAvailable() const
+{
+#ifdef __linux__
+    return _epollFd >= 0;
+#else
+    return false;
+#endif
+}
+
+bool SocketReactor::Register(const std::shared_ptr<NetSocket>& socket, u64 token)
+{
+#ifdef __linux__
+    if (_epollFd < 0)
+        return false;
+
+    i64 handle = GetHandle(socket);
+
+    epoll_event event = {};
+    event.events = EPOLLIN | EPOLLRDHUP; // Level triggered, NetClient::Read() doesn't drain the socket
+    event.data.u64 = token;
+
+    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, static_cast<i32>(handle), &event) != 0)
+    {
+        DebugHandler::PrintWarning("[Network/Reactor]: Failed to register socket (%lld)", static_cast<long long>(handle));
+        return false;
+    }
+
+    _registrations[handle] = { token, event.events };
+    return true;
+#else
+    return false;
+#endif
+}
+
+void SocketReactor::Unregister(const std::shared_ptr<NetSocket>& socket, u64 token)
+{
+#ifdef __linux__
+    if (_epollFd < 0)
+        return;
+
+    i64 handle = GetHandle(socket);
+
+    // The handle might have been closed and handed out to a newer connection already, in that case it is not ours to remove
+    auto itr = _registrations.find(handle);
+    if (itr == _registrations.end() || itr->second.token != token)
+        return;
+
+    // Closed handles are removed from the epoll set automatically, so failing here is fine
+    if (itr->second.events != 0)
+    {
+        epoll_event event = {};
+        epoll_ctl(_epollFd, EPOLL_CTL_DEL, static_cast<i32>(handle), &event);
+    }
+
+    _registrations.erase(itr);
+#endif
+}
+
+bool SocketReactor::SetInterest(const std::shared_ptr<NetSocket>& socket, u64 token, bool isReading, bool isWriting)
+{
+#ifdef __linux__
+    if (_epollFd < 0)
+        return false;
+
+    i64 handle = GetHandle(socket);
+
+    auto itr = _registrations.find(handle);
+    if (itr == _registrations.end() || itr->second.token != token)
+        return false;
+
+    u32 events = (isReading ? EPOLLIN | EPOLLRDHUP : 0) | (isWriting ? EPOLLOUT : 0);
+
+    Registration& registration = itr->second;
+    if (registration.events == events)
+        return true;
+
+    // Level triggered, a socket watched for nothing has to leave the epoll set or its hangup would be reported on every poll
+    epoll_event event = {};
+    event.events = events;
+    event.data.u64 = token;
+
+    i32 operation = registration.events == 0 ? EPOLL_CTL_ADD : (events == 0 ? EPOLL_CTL_DEL : EPOLL_CTL_MOD);
+    if (epoll_ctl(_epollFd, operation, static_cast<i32>(handle), &event) != 0)
+    {
+        DebugHandler::PrintWarning("[Network/Reactor]: Failed to change what socket (%lld) is watched for", static_cast<long long>(handle));
+        return false;
+    }
+
+    registration.events = events;
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool SocketReactor::EnableWake()
+{
+#ifdef __linux__
+    if (_epollFd < 0)
+        return false;
+
+    if (_wakeFd >= 0)
+        return true;
+
+    _wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_wakeFd < 0)
+        return false;
+
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.u64 = WAKE_TOKEN;
+
+    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, _wakeFd, &event) != 0)
+    {
+        close(_wakeFd);
+        _wakeFd = -1;
+        return false;
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+void SocketReactor::Wake()
+{
+#ifdef __linux__
+    if (_wakeFd < 0)
+        return;
+
+    u64 value = 1;
+    [[maybe_unused]] ssize_t result = write(_wakeFd, &value, sizeof(value));
+#endif
+}
+
+void SocketReactor::ReportReady(u64 token)
+{
+    // Nobody polls a reactor that isn't available, every socket is visited anyway
+    if (!IsAvailable())
+        return;
+
+    _reportedTokens.push_back(token);
+}
+
+void SocketReactor::Poll(std::vector<u64>& readyTokens, i32 timeoutMS)
+{
+    Poll(readyTokens, nullptr, timeoutMS);
+}
+
+void SocketReactor::Poll(std::vector<u64>& readyTokens, std::vector<u64>& writableTokens, i32 timeoutMS)
+{
+    Poll(readyTokens, &writableTokens, timeoutMS);
+}
+
+void SocketReactor::Poll(std::vector<u64>& readyTokens, std::vector<u64>* writableTokens, i32 timeoutMS)
+{
+    readyTokens.clear();
+
+    if (writableTokens)
+    {
+        writableTokens->clear();
+    }
+
+#ifdef __linux__
+    if (_epollFd < 0)
+        return;
+
+    // Don't block on epoll while there's something to report already
+    if (!_reportedTokens.empty())
+    {
+        readyTokens.insert(readyTokens.end(), _reportedTokens.begin(), _reportedTokens.end());
+        _reportedTokens.clear();
+        timeoutMS = 0;
+    }
+
+    i32 numEvents = epoll_wait(_epollFd, _events.data(), static_cast<i32>(_events.size()), timeoutMS);
+    for (i32 i = 0; i < numEvents; i++)
+    {
+        u64 token = _events[i].data.u64;
+
+        // A wakeup only has to interrupt epoll_wait, reset the counter and don't report it
+        if (token == WAKE_TOKEN)
+        {
+            u64 value = 0;
+            [[maybe_unused]] ssize_t result = read(_wakeFd, &value, sizeof(value));
+            continue;
+        }
+
+        u32 events = _events[i].events;
+
+        if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+        {
+            readyTokens.push_back(token);
+        }
+
+        // A hangup or error fails the next write, so whoever is waiting to write finds out too
+        if (writableTokens && (events & (EPOLLOUT | EPOLLHUP | EPOLLERR)))
+        {
+            writableTokens->push_back(token);
+        }
+    }
+#endif
+}
+
+i64 SocketReactor::GetHandle(const std::shared_ptr<NetSocket>& socket)
+{
+    return static_cast<i64>(socket->GetSocket());
+}
\ No newline at end of file
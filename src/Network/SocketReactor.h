@@ -0,0 +1,73 @@
+#pragma once
+#include <NovusTypes.h>
+#include <robin_hood.h>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
+class NetSocket;
+
+// Tracks read readiness of sockets so the tick only has to visit the ones that actually have data (or were closed)
+// Only backed by epoll on Linux, IsAvailable() returns false elsewhere and callers should fall back to reading every socket
+class SocketReactor
+{
+public:
+    static constexpr u64 SELF_TOKEN = std::numeric_limits<u64>::max();
+    static constexpr u64 WAKE_TOKEN = std::numeric_limits<u64>::max() - 1;
+
+    SocketReactor();
+    ~SocketReactor();
+
+    SocketReactor(const SocketReactor&) = delete;
+    SocketReactor& operator=(const SocketReactor&) = delete;
+
+    bool IsAvailable() const;
+
+    // Registers for reads, see SetInterest() to change what the socket is watched for
+    bool Register(const std::shared_ptr<NetSocket>& socket, u64 token);
+    void Unregister(const std::shared_ptr<NetSocket>& socket, u64 token);
+
+    // A registered socket that is neither read nor written stays registered but isn't watched at all, not even for hangups
+    // Returns false if the socket isn't registered or the interest couldn't be changed
+    bool SetInterest(const std::shared_ptr<NetSocket>& socket, u64 token, bool isReading, bool isWriting);
+
+    // Lets Wake() interrupt a blocking Poll() from any thread
+    bool EnableWake();
+    void Wake();
+
+    // Has the next Poll() report the token as ready, for sockets we closed ourselves that epoll will never report again
+    void ReportReady(u64 token);
+
+    // Fills readyTokens with the token of every socket that is readable, has hung up or errored, waits at most timeoutMS
+    void Poll(std::vector<u64>& readyTokens, i32 timeoutMS = 0);
+
+    // Same as above, writableTokens gets every socket watched for writes that can take more or has hung up or errored
+    void Poll(std::vector<u64>& readyTokens, std::vector<u64>& writableTokens, i32 timeoutMS = 0);
+
+    size_t GetNumRegistered() const { return _registrations.size(); }
+
+private:
+    struct Registration
+    {
+        u64 token;
+        u32 events;
+    };
+
+    static i64 GetHandle(const std::shared_ptr<NetSocket>& socket);
+
+    void Poll(std::vector<u64>& readyTokens, std::vector<u64>* writableTokens, i32 timeoutMS);
+
+private:
+    robin_hood::unordered_map<i64, Registration> _registrations;
+    std::vector<u64> _reportedTokens;
+
+#ifdef __linux__
+    i32 _epollFd = -1;
+    i32 _wakeFd = -1;
+    std::vector<epoll_event> _events;
+#endif
+};
\ No newline at end of file
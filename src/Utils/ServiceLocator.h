@@ -27,19 +27,12 @@
 #include <Utils/ConcurrentQueue.h>
 #include <Utils/Message.h>
 
-class NetPacketHandler;
 class ServiceLocator
 {
 public:
     static entt::registry* GetRegistry() { return _gameRegistry; }
     static void SetRegistry(entt::registry* registry);
-    static NetPacketHandler* GetSelfNetPacketHandler() { return _selfNetPacketHandler; }
-    static void SetSelfNetPacketHandler(NetPacketHandler* selfNetPacketHandler);
-    static NetPacketHandler* GetClientNetPacketHandler() { return _clientNetPacketHandler; }
-    static void SetClientNetPacketHandler(NetPacketHandler* clientNetPacketHandler);
 
 private:
     static entt::registry* _gameRegistry;
-    static NetPacketHandler* _selfNetPacketHandler;
-    static NetPacketHandler* _clientNetPacketHandler;
 };
\ No newline at end of file